@@ -12,123 +12,236 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/crc32c.h"
+#include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
     : pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
+      frame_arena_(pool_size),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(pool_size),
+      frame_states_(pool_size, FrameState::FREE),
+      frame_cvs_(pool_size),
+      frame_writing_(pool_size, false),
+      scan_ring_capacity_(std::max<size_t>(1, std::min<size_t>(SCAN_RING_SIZE, pool_size / 4))),
+      read_ahead_worker_(this) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
   // We allocate a consecutive memory space for the buffer pool.
-
   pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].data_ = frame_arena_.GetFrame(static_cast<frame_id_t>(i));
+  }
+  switch (replacer_type) {
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  // Continue allocating after every page id handed out before, rounded up to an id of this BPI.
+  free_page_map_ = disk_manager_->OpenFreePageMap(instance_index_);
+  const page_id_t next_page_id = std::max<page_id_t>(free_page_map_->GetNextPageId(), instance_index_);
+  next_page_id_ = next_page_id + (instance_index_ + num_instances_ - next_page_id % num_instances_) % num_instances_;
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  read_ahead_worker_.Stop();
   delete[] pages_;
   delete replacer_;
+  // free_page_map_ writes itself out when destroyed
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
-  const std::lock_guard<std::mutex> lock(latch_);
-  // Make sure you call DiskManager::WritePage!
-  if(page_id == INVALID_PAGE_ID) {
+  if (page_id == INVALID_PAGE_ID) {
     return false;
   }
 
-  if(page_table_.count(page_id) == 0) {
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  while (page_table_.Find(page_id, &frame_id)) {
+    if (frame_states_[frame_id] != FrameState::READY) {
+      WaitForFrame(&lock, frame_id);
+    } else if (frame_writing_[frame_id]) {
+      // A write of the page is already in flight, maybe of an older image, and this one has to land after it.
+      WaitForWriteBack(&lock, frame_id);
+    } else {
+      break;
+    }
+  }
+  if (!page_table_.Find(page_id, &frame_id)) {
     return false;
   }
 
-  frame_id_t frame_id = page_table_[page_id];
-  // find the corresponding frame id,
-  
-  // write the page using the diskmanager.
-
-  disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-  pages_[frame_id].is_dirty_ = false;
-  // add it to the freelist,
-  // no need to erase it here.
+  // Pin the page so that it stays in its frame while the write runs without the latch. The dirty flag is cleared
+  // up front, so that an unpin marking the page dirty during the write is not lost.
+  Page *page = &pages_[frame_id];
+  AddPin(page);
+  page->is_dirty_ = false;
+  frame_writing_[frame_id] = true;
+  lock.unlock();
 
+  // The page is copied out under its latch, so that the checksum is that of the image written.
+  alignas(PAGE_SIZE) char data[PAGE_SIZE];
+  page->RLatch();
+  memcpy(data, page->GetData(), PAGE_SIZE);
+  page->RUnlatch();
+  BeginChecksumWrite(page_id);
+  disk_manager_->WritePage(page_id, data);
+  StoreChecksum(page_id, data);
+  FinishWriteBacks({frame_id});
+  DropPin(page);
+  metrics_.Add(BPM_FLUSHED_PAGES);
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  const std::lock_guard<std::mutex> lock(latch_);
-  for (size_t i = 0; i < pool_size_; ++i) {
-    FlushPgImp(pages_[i].page_id_);
-  }
+  FlushDirtyPages(nullptr);
+  std::scoped_lock lock{allocation_latch_};
+  free_page_map_->Flush();
 }
 
-/**
- * I've not catch the point why this function is useful?? why do we need new PAGE??? NEXT PAGE???
- */
-Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
-  
-  const std::lock_guard<std::mutex> lock(latch_);
-  frame_id_t frame_avail = 0;
-  page_id_t next_page;
-
-  if (free_list_.empty() && (!replacer_->Victim(&frame_avail))) {
-    return nullptr;
-  }
-
-  if (!free_list_.empty()) {
-    frame_avail = free_list_.back();
-    free_list_.pop_back();        // get the frame_id;
-  } else {                        // no frames in the freelist, find one with the help of replacer.
-                                  // should reuse the code here, but no need for a helper function,
-    replacer_->Pin(frame_avail);  // found one from replacer, pin it, since it would later be used.
-    // do not call Victim() again, here;
-    if (pages_[frame_avail].is_dirty_) {
-      disk_manager_->WritePage(pages_[frame_avail].page_id_, pages_[frame_avail].GetData());
+void BufferPoolManagerInstance::FlushDirtyPages(const std::function<bool(page_id_t)> &filter) {
+  // Clean pages are skipped, and the dirty ones are written in page id order, which is their order in the file.
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty;
+  {
+    const auto lock = LockLatch();
+    for (size_t i = 0; i < pool_size_; ++i) {
+      if (frame_states_[i] == FrameState::READY && pages_[i].is_dirty_ && (!filter || filter(pages_[i].page_id_))) {
+        dirty.emplace_back(pages_[i].page_id_, static_cast<frame_id_t>(i));
+      }
     }
-    page_table_.erase(pages_[frame_avail].page_id_);
   }
-  next_page = AllocatePage();  // get the page id;
-  *page_id = next_page;
+  std::sort(dirty.begin(), dirty.end());
 
-  pages_[frame_avail].pin_count_ += 1;  // update P's meta data;
-  pages_[frame_avail].page_id_ = next_page;
-  pages_[frame_avail].is_dirty_ = false;
-  pages_[frame_avail].ResetMemory();
-
-  // std::cout << "pin_count of a new page shoudl be 1, actually it is"<<
-  //          pages_[frame_avail].pin_count_<< std::endl;
+  if (dirty.empty()) {
+    return;
+  }
 
-  page_table_.insert({next_page, frame_avail});  // update page_table;
+  // Only one batch of pages is pinned at a time, so that the rest of the pool can still be evicted during the flush.
+  // As in FlushPgImp, the pages are written from copies taken under their latches.
+  FrameArena buffers(std::min<size_t>(dirty.size(), ASYNC_IO_QUEUE_DEPTH));
+  std::vector<frame_id_t> batch;
+  std::vector<std::future<bool>> writes;
+  size_t next = 0;
+  while (next < dirty.size()) {
+    {
+      auto lock = LockLatch();
+      for (; next < dirty.size() && batch.size() < static_cast<size_t>(ASYNC_IO_QUEUE_DEPTH); ++next) {
+        const auto [page_id, frame_id] = dirty[next];
+        Page *page = &pages_[frame_id];
+        if (frame_writing_[frame_id] && page->page_id_ == page_id) {
+          // Same as FlushPgImp, a write already in flight is waited for. Only a flush that has claimed no page yet
+          // waits, so that two flushes never wait for each other; otherwise the page goes into the next batch.
+          if (!batch.empty()) {
+            break;
+          }
+          WaitForWriteBack(&lock, frame_id);
+        }
+        // The page may have been written back or evicted since it was collected.
+        if (frame_states_[frame_id] != FrameState::READY || page->page_id_ != page_id || !page->is_dirty_) {
+          continue;
+        }
+        // Same as FlushPgImp: pinned for the duration of the write, dirty flag cleared up front.
+        AddPin(page);
+        page->is_dirty_ = false;
+        frame_writing_[frame_id] = true;
+        batch.push_back(frame_id);
+      }
+    }
 
-  return &pages_[frame_avail];
-  // why allocate page() is called should be further clarified, useful in the case of parallel BPI, I suppose.
+    for (size_t i = 0; i < batch.size(); ++i) {
+      Page *page = &pages_[batch[i]];
+      char *buffer = buffers.GetFrame(static_cast<frame_id_t>(i));
+      page->RLatch();
+      memcpy(buffer, page->GetData(), PAGE_SIZE);
+      page->RUnlatch();
+      BeginChecksumWrite(page->page_id_);
+      writes.push_back(disk_manager_->WritePageAsync(page->page_id_, buffer));
+    }
+    if (!batch.empty()) {
+      disk_manager_->SubmitAsync();
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+      Page *page = &pages_[batch[i]];
+      if (writes[i].get()) {
+        StoreChecksum(page->page_id_, buffers.GetFrame(static_cast<frame_id_t>(i)));
+        metrics_.Add(BPM_FLUSHED_PAGES);
+      } else {
+        page->is_dirty_ = true;
+      }
+    }
+    FinishWriteBacks(batch);
+    for (frame_id_t frame_id : batch) {
+      DropPin(&pages_[frame_id]);
+    }
+    batch.clear();
+    writes.clear();
+  }
+}
 
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  return nullptr;
+  // The id is allocated before taking the latch, as the free page map may write to disk. Without a frame it is
+  // returned, so that the next call hands it out again.
+  bool reused;
+  const page_id_t new_page_id = AllocatePage(&reused);
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  if (!AcquireFrame(&frame_id)) {
+    lock.unlock();
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  *page_id = new_page_id;
+  Page *page = InstallPage(&lock, frame_id, *page_id, false, AccessType::Unknown);
+  // A reused id still has the deleted page on disk, so the zeroed frame is written back even if the caller never
+  // changes it. Otherwise a fetch after its eviction would read the deleted page.
+  page->is_dirty_ = reused;
+  return page;
 }
 
-Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessType access_type) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -136,112 +249,777 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  const std::lock_guard<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && TryPin(frame_id, page_id, access_type)) {
+    metrics_.Add(BPM_HITS);
+    return &pages_[frame_id];
+  }
 
-  frame_id_t frame_id = 0;
+  auto lock = LockLatch();
+  while (true) {
+    if (page_table_.Find(page_id, &frame_id)) {
+      if (frame_states_[frame_id] != FrameState::READY) {
+        // Somebody else is reading P in; wait for that frame only and look again.
+        WaitForFrame(&lock, frame_id);
+        continue;
+      }
+      // Under the latch a READY frame cannot be claimed for eviction, so this only fails on a stray lookup.
+      if (TryPin(frame_id, page_id, access_type)) {
+        metrics_.Add(BPM_HITS);
+        return &pages_[frame_id];
+      }
+      continue;
+    }
 
-  if (page_table_.count(page_id) != 0) {  // it exists in the pagetable
-    frame_id = page_table_[page_id];
-    pages_[frame_id].pin_count_ += 1;
-    replacer_->Pin(frame_id);
+    auto evicting = evicting_pages_.find(page_id);
+    if (evicting != evicting_pages_.end()) {
+      // P is being written back out of a victim frame. Reading it now could return stale contents.
+      WaitForFrame(&lock, evicting->second);
+      continue;
+    }
+    break;
+  }
 
-    return &pages_[frame_id];
-  }   // not in the pagetable, find it from the freelist, then try to victim a frame from replacer.
-    
-  if (free_list_.empty() ) {
-    if (replacer_->Size() == 0) {
-      return nullptr;
-    } 
-              // evict a frame, we have to flush it back to disk before returning the pointer to frame.
-    replacer_->Victim(&frame_id);
-    if (pages_[frame_id].is_dirty_) {
-      disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].GetData()); 
-    }
-        // update pagetable;
-    page_table_.erase(pages_[frame_id].page_id_);
-    replacer_->Pin(frame_id);
-             // page found in the replacer.
-  } else {  // found in the freelist
-    frame_id = free_list_.back();
-      free_list_.pop_back();
-  }
-    // found the frame_id;
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;
-  pages_[frame_id].ResetMemory();
-
-  disk_manager_->ReadPage(pages_[frame_id].page_id_, pages_[frame_id].GetData());
-    // update for replacer done solely for cases where the page is found in the replacer.
-  page_table_.insert({page_id, frame_id});
-  return &pages_[frame_id];
-  
+  metrics_.Add(BPM_MISSES);
+  const bool acquired = access_type == AccessType::Scan ? AcquireScanFrame(&frame_id) : AcquireFrame(&frame_id);
+  if (!acquired) {
+    return nullptr;
+  }
+  return InstallPage(&lock, frame_id, page_id, true, access_type);
 }
 
-bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
-  
-  const std::lock_guard<std::mutex> lock(latch_);
-  DeallocatePage(page_id);
-  if (page_table_.count(page_id) == 0) {
-    return true;
+std::vector<Page *> BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids,
+                                                          AccessType access_type) {
+  PendingFetch fetch = StartFetchPages(page_ids, access_type);
+  return FinishFetchPages(&fetch);
+}
+
+BufferPoolManagerInstance::PendingFetch BufferPoolManagerInstance::StartFetchPages(
+    const std::vector<page_id_t> &page_ids, AccessType access_type) {
+  PendingFetch fetch;
+  fetch.page_ids_ = page_ids;
+  fetch.access_type_ = access_type;
+  fetch.pages_.assign(page_ids.size(), nullptr);
+  std::vector<size_t> misses;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    frame_id_t frame_id;
+    if (page_table_.Find(page_ids[i], &frame_id) && TryPin(frame_id, page_ids[i], access_type)) {
+      metrics_.Add(BPM_HITS);
+      fetch.pages_[i] = &pages_[frame_id];
+    } else {
+      misses.push_back(i);
+    }
   }
-  frame_id_t frame_id;
-  frame_id = page_table_[page_id];
-  if (pages_[frame_id].pin_count_ > 0) {
-    return false;
+  if (misses.empty()) {
+    return fetch;
   }
-  if(pages_[frame_id].is_dirty_) {
-    disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].GetData());
+
+  // Claim a frame for every missing page under one acquisition of the latch. A page that is being loaded or written
+  // back, by another thread or by this batch if it appears twice, is deferred rather than waited for with the frames
+  // of the batch claimed.
+  {
+    auto lock = LockLatch();
+    bool out_of_frames = false;
+    for (size_t i : misses) {
+      const page_id_t page_id = page_ids[i];
+      frame_id_t frame_id;
+      if (page_table_.Find(page_id, &frame_id)) {
+        if (frame_states_[frame_id] == FrameState::READY && TryPin(frame_id, page_id, access_type)) {
+          metrics_.Add(BPM_HITS);
+          fetch.pages_[i] = &pages_[frame_id];
+        } else {
+          fetch.deferred_.push_back(i);
+        }
+        continue;
+      }
+      if (evicting_pages_.count(page_id) != 0) {
+        fetch.deferred_.push_back(i);
+        continue;
+      }
+      metrics_.Add(BPM_MISSES);
+      if (out_of_frames) {
+        continue;
+      }
+      out_of_frames = !(access_type == AccessType::Scan ? AcquireScanFrame(&frame_id) : AcquireFrame(&frame_id));
+      if (!out_of_frames) {
+        fetch.installs_.emplace_back(i, BeginInstall(frame_id, page_id));
+      }
+    }
   }
-  page_table_.erase(page_id);
 
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 0;
-  pages_[frame_id].ResetMemory();
+  // The reads go out in one batch, together with the write-backs of dirty victims. A frame that has to be written
+  // back is only read into once its write-back completed, in a second batch issued by FinishFetchPages.
+  for (const auto &[i, install] : fetch.installs_) {
+    char *data = pages_[install.frame_id_].GetData();
+    if (install.write_back_page_id_ != INVALID_PAGE_ID) {
+      BeginChecksumWrite(install.write_back_page_id_);
+      fetch.writes_.push_back(disk_manager_->WritePageAsync(install.write_back_page_id_, data));
+    } else {
+      fetch.reads_.push_back(disk_manager_->ReadPageAsync(install.page_id_, data));
+    }
+  }
+  if (!fetch.installs_.empty()) {
+    disk_manager_->SubmitAsync();
+  }
+  return fetch;
+}
 
-  free_list_.push_back(frame_id);
-  
+std::vector<Page *> BufferPoolManagerInstance::FinishFetchPages(PendingFetch *fetch) {
+  const std::vector<page_id_t> &page_ids = fetch->page_ids_;
+  std::vector<Page *> &pages = fetch->pages_;
+  const auto &installs = fetch->installs_;
+  for (auto &write : fetch->writes_) {
+    write.get();
+  }
+  if (!fetch->writes_.empty()) {
+    for (const auto &[i, install] : installs) {
+      if (install.write_back_page_id_ != INVALID_PAGE_ID) {
+        StoreChecksum(install.write_back_page_id_, pages_[install.frame_id_].GetData());
+        fetch->reads_.push_back(disk_manager_->ReadPageAsync(install.page_id_, pages_[install.frame_id_].GetData()));
+      }
+    }
+    disk_manager_->SubmitAsync();
+  }
+  for (auto &read : fetch->reads_) {
+    read.get();
+  }
+
+  std::vector<bool> verified;
+  verified.reserve(installs.size());
+  for (const auto &[i, install] : installs) {
+    verified.push_back(VerifyChecksum(install.page_id_, pages_[install.frame_id_].GetData()));
+  }
+
+  page_id_t corrupt_page_id = INVALID_PAGE_ID;
+  if (!installs.empty()) {
+    const auto lock = LockLatch();
+    for (size_t j = 0; j < installs.size(); ++j) {
+      const auto &[i, install] = installs[j];
+      if (!verified[j]) {
+        corrupt_page_id = install.page_id_;
+        AbortInstall(install);
+        continue;
+      }
+      FinishInstall(install, fetch->access_type_);
+      pages[i] = &pages_[install.frame_id_];
+    }
+  }
+  try {
+    if (corrupt_page_id != INVALID_PAGE_ID) {
+      ThrowCorruptPage(corrupt_page_id);
+    }
+    for (size_t i : fetch->deferred_) {
+      pages[i] = FetchPgImp(page_ids[i], fetch->access_type_);
+    }
+  } catch (const Exception &) {
+    // A batch with a corrupt page fails as a whole, so the pages it did fetch are unpinned again.
+    for (size_t i = 0; i < pages.size(); ++i) {
+      if (pages[i] != nullptr) {
+        UnpinPgImp(page_ids[i], false);
+      }
+    }
+    throw;
+  }
+  return std::move(pages);
+}
 
+bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  auto lock = LockLatch();
+  frame_id_t frame_id;
+  while (page_table_.Find(page_id, &frame_id) && frame_states_[frame_id] != FrameState::READY) {
+    WaitForFrame(&lock, frame_id);
+  }
+  if (page_table_.Find(page_id, &frame_id)) {
+    Page *page = &pages_[frame_id];
+    int unpinned = 0;
+    if (!page->pin_count_.compare_exchange_strong(unpinned, PIN_COUNT_BUSY)) {
+      return false;
+    }
+    FreeFrame(frame_id);
+  }
+  lock.unlock();
+  DeallocatePage(page_id);
   return true;
 }
 
-bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  const std::lock_guard<std::mutex> lock(latch_);
+bool BufferPoolManagerInstance::EvictPgImp(page_id_t page_id) {
+  auto lock = LockLatch();
   frame_id_t frame_id;
-  if (page_table_.count(page_id) == 0) {
+  while (page_table_.Find(page_id, &frame_id) && frame_states_[frame_id] != FrameState::READY) {
+    WaitForFrame(&lock, frame_id);
+  }
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return true;
+  }
+
+  Page *page = &pages_[frame_id];
+  int unpinned = 0;
+  if (!page->pin_count_.compare_exchange_strong(unpinned, PIN_COUNT_BUSY)) {
     return false;
   }
+  // Unlike eviction on the fetch path this writes under the latch. It only runs while the parallel BPM is being
+  // resized, which flushes the pages it moves beforehand.
+  if (page->is_dirty_) {
+    BeginChecksumWrite(page_id);
+    disk_manager_->WritePage(page_id, page->GetData());
+    StoreChecksum(page_id, page->GetData());
+  }
+  FreeFrame(frame_id);
+  return true;
+}
+
+std::vector<page_id_t> BufferPoolManagerInstance::GetResidentPageIds() {
+  const auto lock = LockLatch();
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size_; ++i) {
+    if (frame_states_[i] != FrameState::FREE) {
+      page_ids.push_back(pages_[i].page_id_);
+    }
+  }
+  return page_ids;
+}
 
-  frame_id = page_table_[page_id];
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
   Page *page = &pages_[frame_id];
+  page_table_.Remove(page->page_id_);
+  replacer_->Remove(frame_id);
 
-  if (page->pin_count_ == 0) {
-    return false;
+  page->BeginWrite();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  page->ref_bit_ = false;
+  page->ResetMemory();
+  page->EndWrite();
+  page->pin_count_ = 0;
+  frame_states_[frame_id] = FrameState::FREE;
+  free_list_.push_back(frame_id);
+}
+
+OptimisticPageGuard BufferPoolManagerInstance::FetchPageOptimistic(page_id_t page_id) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return {};
   }
-  page->pin_count_--;
+  // The version is even only while the frame holds a READY page, and the page id is read after it, so a match means
+  // the frame held page_id at that version. Reserved page table entries of pages being loaded fail here.
+  Page *page = &pages_[frame_id];
+  const uint64_t version = page->GetVersion();
+  if ((version & 1) != 0 || page->page_id_ != page_id) {
+    return {};
+  }
+  // Like TryPin, only writes the reference bit if it is not set yet.
+  if (!page->ref_bit_.load(std::memory_order_relaxed)) {
+    page->ref_bit_.store(true, std::memory_order_relaxed);
+  }
+  metrics_.Add(BPM_HITS);
+  return {page, version};
+}
 
+bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // A lock-free lookup can miss an entry that a concurrent removal is moving; only a miss under the latch counts.
+    const auto lock = LockLatch();
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+  }
+
+  // While the caller holds its pin the frame cannot be recycled, so a mismatch means the caller holds no pin.
+  Page *page = &pages_[frame_id];
+  if (page->page_id_ != page_id) {
+    return false;
+  }
+  int pin_count = page->pin_count_;
+  if (pin_count <= 0) {
+    return false;
+  }
+  // The dirty flag has to be visible before the pin is dropped, or the frame could be evicted without write-back.
   if (is_dirty) {
     page->is_dirty_ = true;
   }
+  while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+    if (pin_count <= 0) {
+      return false;
+    }
+  }
+  if (pin_count == 1) {
+    pinned_frames_--;
+  }
+  return true;
+}
 
-  // replacer?
-  if (page->pin_count_ == 0) {
-    replacer_->Unpin(frame_id);
+BufferPoolStats BufferPoolManagerInstance::GetStats() {
+  BufferPoolStats stats;
+  stats.hits_ = metrics_.Sum(BPM_HITS);
+  stats.misses_ = metrics_.Sum(BPM_MISSES);
+  stats.evictions_ = metrics_.Sum(BPM_EVICTIONS);
+  stats.dirty_write_backs_ = metrics_.Sum(BPM_DIRTY_WRITE_BACKS);
+  stats.flushed_pages_ = metrics_.Sum(BPM_FLUSHED_PAGES);
+  stats.pin_waits_ = metrics_.Sum(BPM_PIN_WAITS);
+  stats.latch_waits_ = metrics_.Sum(BPM_LATCH_WAITS);
+  stats.latch_wait_ns_ = metrics_.Sum(BPM_LATCH_WAIT_NS);
+  stats.replacer_skips_ = metrics_.Sum(BPM_REPLACER_SKIPS);
+  stats.checksums_written_ = metrics_.Sum(BPM_CHECKSUMS_WRITTEN);
+  stats.checksums_verified_ = metrics_.Sum(BPM_CHECKSUMS_VERIFIED);
+  stats.checksum_failures_ = metrics_.Sum(BPM_CHECKSUM_FAILURES);
+  stats.checksums_pending_ = metrics_.Sum(BPM_CHECKSUMS_PENDING);
+  stats.pool_size_ = pool_size_;
+  // Taken directly rather than through LockLatch, so that looking at the stats does not show up in them.
+  const std::lock_guard<std::mutex> lock(latch_);
+  stats.free_frames_ = free_list_.size();
+  stats.evictable_frames_ = replacer_->Size();
+  return stats;
+}
+
+std::unique_lock<std::mutex> BufferPoolManagerInstance::LockLatch() {
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    const auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    const auto waited = std::chrono::steady_clock::now() - start;
+    metrics_.Add(BPM_LATCH_WAITS);
+    metrics_.Add(BPM_LATCH_WAIT_NS, std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count());
   }
+  return lock;
+}
+
+void BufferPoolManagerInstance::WaitForFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  metrics_.Add(BPM_PIN_WAITS);
+  frame_cvs_[frame_id].wait(*lock, [&] {
+    return frame_states_[frame_id] != FrameState::EVICTING && frame_states_[frame_id] != FrameState::LOADING;
+  });
+}
+
+void BufferPoolManagerInstance::WaitForWriteBack(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  metrics_.Add(BPM_PIN_WAITS);
+  frame_cvs_[frame_id].wait(*lock, [&] { return !frame_writing_[frame_id]; });
+}
+
+void BufferPoolManagerInstance::FinishWriteBacks(const std::vector<frame_id_t> &frame_ids) {
+  if (frame_ids.empty()) {
+    return;
+  }
+  const auto lock = LockLatch();
+  for (frame_id_t frame_id : frame_ids) {
+    frame_writing_[frame_id] = false;
+    frame_cvs_[frame_id].notify_all();
+  }
+}
+
+bool BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    // A free frame can only be pinned by a stray lock-free lookup, which backs off right away.
+    int unpinned = 0;
+    while (!pages_[*frame_id].pin_count_.compare_exchange_weak(unpinned, PIN_COUNT_BUSY)) {
+      unpinned = 0;
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  // Every frame proposed by the replacer is visited at most twice: once to clear its reference bit and once more to
+  // find it pinned. Pinned frames stay out of the replacer until the search is over, or a policy that keeps
+  // proposing the same frame would never get past it; they go back in with their access history untouched.
+  std::vector<frame_id_t> pinned;
+  bool found = false;
+  const size_t max_attempts = 2 * replacer_->Size();
+  for (size_t attempt = 0; attempt < max_attempts && replacer_->Victim(frame_id); ++attempt) {
+    Page *page = &pages_[*frame_id];
+    if (page->ref_bit_.exchange(false)) {
+      replacer_->Unpin(*frame_id);
+      metrics_.Add(BPM_REPLACER_SKIPS);
+      continue;
+    }
+    int unpinned = 0;
+    if (page->pin_count_.compare_exchange_strong(unpinned, PIN_COUNT_BUSY)) {
+      replacer_->Remove(*frame_id);
+      found = true;
+      break;
+    }
+    pinned.push_back(*frame_id);
+    metrics_.Add(BPM_REPLACER_SKIPS);
+  }
+  for (frame_id_t pinned_frame : pinned) {
+    replacer_->Unpin(pinned_frame);
+  }
+  return found;
+}
+
+bool BufferPoolManagerInstance::AcquireScanFrame(frame_id_t *frame_id) {
+  if (scan_ring_.size() == scan_ring_capacity_) {
+    // The next ring frame is reused unless it is in use or was referenced by a non-scan access since it was loaded.
+    const frame_id_t candidate = scan_ring_[scan_ring_next_];
+    Page *page = &pages_[candidate];
+    int unpinned = 0;
+    if (frame_states_[candidate] == FrameState::READY && !page->ref_bit_ &&
+        page->pin_count_.compare_exchange_strong(unpinned, PIN_COUNT_BUSY)) {
+      replacer_->Remove(candidate);
+      *frame_id = candidate;
+      scan_ring_next_ = (scan_ring_next_ + 1) % scan_ring_capacity_;
+      return true;
+    }
+  }
+
+  if (!AcquireFrame(frame_id)) {
+    return false;
+  }
+  if (scan_ring_.size() < scan_ring_capacity_) {
+    scan_ring_.push_back(*frame_id);
+  } else {
+    scan_ring_[scan_ring_next_] = *frame_id;
+    scan_ring_next_ = (scan_ring_next_ + 1) % scan_ring_capacity_;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::AddPin(Page *page) {
+  if (page->pin_count_.fetch_add(1) == 0) {
+    pinned_frames_++;
+  }
+}
+
+void BufferPoolManagerInstance::DropPin(Page *page) {
+  if (page->pin_count_.fetch_sub(1) == 1) {
+    pinned_frames_--;
+  }
+}
+
+bool BufferPoolManagerInstance::TryPin(frame_id_t frame_id, page_id_t page_id, AccessType access_type) {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  if (pin_count == 0) {
+    pinned_frames_++;
+  }
+
+  // The frame may have been recycled between the page table lookup and the pin.
+  if (page->page_id_ != page_id) {
+    DropPin(page);
+    return false;
+  }
+  if (access_type != AccessType::Scan && !page->ref_bit_.load(std::memory_order_relaxed)) {
+    page->ref_bit_.store(true, std::memory_order_relaxed);
+  }
+  replacer_->RecordAccess(frame_id, access_type);
   return true;
 }
 
-page_id_t BufferPoolManagerInstance::AllocatePage() {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
-  ValidatePageId(next_page_id);
-  return next_page_id;
+BufferPoolManagerInstance::PendingInstall BufferPoolManagerInstance::BeginInstall(frame_id_t frame_id,
+                                                                                  page_id_t page_id) {
+  // The frame has been claimed by AcquireFrame, so its pin count is PIN_COUNT_BUSY and lock-free pins fail.
+  Page *page = &pages_[frame_id];
+  const page_id_t old_page_id = page->page_id_;
+  const bool write_back = old_page_id != INVALID_PAGE_ID && page->is_dirty_;
+
+  // Reserve the page table entry before dropping the latch, so that concurrent fetchers of page_id find this frame
+  // and wait for it rather than loading a second copy.
+  if (old_page_id != INVALID_PAGE_ID) {
+    page_table_.Remove(old_page_id);
+    metrics_.Add(BPM_EVICTIONS);
+  }
+  if (write_back) {
+    evicting_pages_[old_page_id] = frame_id;
+    metrics_.Add(BPM_DIRTY_WRITE_BACKS);
+  }
+  page_table_.Insert(page_id, frame_id);
+  frame_states_[frame_id] = write_back ? FrameState::EVICTING : FrameState::LOADING;
+  // Optimistic readers of the old page fail from here on, and those of the new one until it is READY.
+  page->BeginWrite();
+  page->page_id_ = INVALID_PAGE_ID;
+  return {frame_id, page_id, write_back ? old_page_id : INVALID_PAGE_ID};
+}
+
+void BufferPoolManagerInstance::FinishInstall(const PendingInstall &install, AccessType access_type) {
+  Page *page = &pages_[install.frame_id_];
+  if (install.write_back_page_id_ != INVALID_PAGE_ID) {
+    evicting_pages_.erase(install.write_back_page_id_);
+  }
+  page->is_dirty_ = false;
+  page->ref_bit_ = access_type != AccessType::Scan;
+  page->page_id_ = install.page_id_;
+  page->EndWrite();
+  page->pin_count_ = 1;
+  pinned_frames_++;
+  replacer_->Unpin(install.frame_id_);
+  replacer_->RecordAccess(install.frame_id_, access_type);
+  frame_states_[install.frame_id_] = FrameState::READY;
+  frame_cvs_[install.frame_id_].notify_all();
+}
+
+void BufferPoolManagerInstance::AbortInstall(const PendingInstall &install) {
+  if (install.write_back_page_id_ != INVALID_PAGE_ID) {
+    evicting_pages_.erase(install.write_back_page_id_);
+  }
+  page_table_.Remove(install.page_id_);
+  // FreeFrame starts a write of its own, so the one of BeginInstall ends here.
+  pages_[install.frame_id_].EndWrite();
+  FreeFrame(install.frame_id_);
+  frame_cvs_[install.frame_id_].notify_all();
+}
+
+void BufferPoolManagerInstance::BeginChecksumWrite(page_id_t page_id) {
+  if (page_checksums_.load(std::memory_order_relaxed)) {
+    disk_manager_->MarkChecksumPending(page_id);
+  } else {
+    disk_manager_->ClearChecksum(page_id);
+  }
+}
+
+void BufferPoolManagerInstance::StoreChecksum(page_id_t page_id, const char *data) {
+  if (!page_checksums_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  disk_manager_->WriteChecksum(page_id, Crc32c::Compute(data, PAGE_SIZE));
+  metrics_.Add(BPM_CHECKSUMS_WRITTEN);
+}
+
+bool BufferPoolManagerInstance::VerifyChecksum(page_id_t page_id, const char *data) {
+  if (!page_checksums_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  uint32_t checksum;
+  if (!disk_manager_->ReadChecksum(page_id, &checksum)) {
+    // A page is only read while no write of it is in flight, so a pending write is one the process did not live to
+    // finish. The page may be its old image, its new one or a torn mix of both: it is handed out for redo from the
+    // log to restore, and gets its checksum back when it is written again.
+    if (disk_manager_->IsChecksumPending(page_id)) {
+      LOG_WARN("page %d was read back after an unfinished write and needs redo", page_id);
+      metrics_.Add(BPM_CHECKSUMS_PENDING);
+    }
+    return true;
+  }
+  metrics_.Add(BPM_CHECKSUMS_VERIFIED);
+  if (Crc32c::Compute(data, PAGE_SIZE) == checksum) {
+    return true;
+  }
+  metrics_.Add(BPM_CHECKSUM_FAILURES);
+  LOG_WARN("page %d does not match its checksum", page_id);
+  return false;
+}
+
+void BufferPoolManagerInstance::ThrowCorruptPage(page_id_t page_id) {
+  throw Exception(ExceptionType::CORRUPT_PAGE, "page " + std::to_string(page_id) + " does not match its checksum");
+}
+
+Page *BufferPoolManagerInstance::InstallPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                                             page_id_t page_id, bool read_from_disk, AccessType access_type) {
+  Page *page = &pages_[frame_id];
+  const PendingInstall install = BeginInstall(frame_id, page_id);
+  const bool write_back = install.write_back_page_id_ != INVALID_PAGE_ID;
+
+  if (!write_back && !read_from_disk) {
+    // Nothing to wait for: a fresh page over a clean frame only needs zeroing.
+    page->ResetMemory();
+  } else {
+    lock->unlock();
+    if (write_back) {
+      BeginChecksumWrite(install.write_back_page_id_);
+      disk_manager_->WritePage(install.write_back_page_id_, page->GetData());
+      StoreChecksum(install.write_back_page_id_, page->GetData());
+    }
+    bool verified = true;
+    if (read_from_disk) {
+      disk_manager_->ReadPage(page_id, page->GetData());
+      verified = VerifyChecksum(page_id, page->GetData());
+    } else {
+      page->ResetMemory();
+    }
+    lock->lock();
+    if (!verified) {
+      AbortInstall(install);
+      ThrowCorruptPage(page_id);
+    }
+  }
+
+  FinishInstall(install, access_type);
+  return page;
+}
+
+void BufferPoolManagerInstance::ReadAhead(page_id_t page_id, next_page_fn next_page, size_t num_pages) {
+  read_ahead_worker_.Schedule(page_id, next_page, num_pages);
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter() {
+  const std::lock_guard<std::mutex> guard(bg_writer_latch_);
+  if (bg_writer_thread_ != nullptr) {
+    return;
+  }
+  bg_writer_running_ = true;
+  bg_writer_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(bg_writer_latch_);
+    while (bg_writer_running_) {
+      lock.unlock();
+      BackgroundWriterRound();
+      lock.lock();
+      bg_writer_cv_.wait_for(lock, bg_writer_delay, [this] { return !bg_writer_running_; });
+    }
+  });
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  std::thread *thread;
+  {
+    const std::lock_guard<std::mutex> guard(bg_writer_latch_);
+    if (bg_writer_thread_ == nullptr) {
+      return;
+    }
+    bg_writer_running_ = false;
+    thread = bg_writer_thread_;
+    bg_writer_thread_ = nullptr;
+  }
+  bg_writer_cv_.notify_all();
+  thread->join();
+  delete thread;
+}
+
+size_t BufferPoolManagerInstance::BackgroundWriterRound() {
+  const auto clean_target = static_cast<size_t>(bg_writer_clean_target * pool_size_);
+  size_t clean;
+  {
+    const auto lock = LockLatch();
+    clean = free_list_.size();
+  }
+  // A racy count is good enough to decide whether there is work to do.
+  for (size_t i = 0; i < pool_size_ && clean < clean_target; ++i) {
+    const Page &page = pages_[i];
+    if (page.page_id_ != INVALID_PAGE_ID && page.pin_count_ == 0 && !page.is_dirty_) {
+      clean++;
+    }
+  }
+  if (clean >= clean_target) {
+    return 0;
+  }
+
+  // The first sweep only writes pages whose reference bit is clear, which are next in line for eviction. Referenced
+  // pages are only written if that is not enough, since they are likely to be dirtied again.
+  std::vector<frame_id_t> batch;
+  const size_t max_pages = std::min<size_t>(bg_writer_max_pages, pool_size_);
+  if (bg_writer_buffers_ == nullptr || bg_writer_buffers_size_ < max_pages) {
+    bg_writer_buffers_ = std::make_unique<FrameArena>(max_pages);
+    bg_writer_buffers_size_ = max_pages;
+  }
+  const FrameArena &buffers = *bg_writer_buffers_;
+  for (int sweep = 0; sweep < 2; ++sweep) {
+    for (size_t step = 0; step < pool_size_ && clean < clean_target && batch.size() < max_pages; ++step) {
+      const auto frame_id = static_cast<frame_id_t>(bg_writer_hand_);
+      bg_writer_hand_ = (bg_writer_hand_ + 1) % pool_size_;
+      char *buffer = buffers.GetFrame(static_cast<frame_id_t>(batch.size()));
+      if (PrepareBackgroundWrite(frame_id, sweep > 0, buffer)) {
+        batch.push_back(frame_id);
+        clean++;
+      }
+    }
+  }
+
+  // All writes of the round are in flight at once.
+  std::vector<std::future<bool>> writes;
+  writes.reserve(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    char *buffer = buffers.GetFrame(static_cast<frame_id_t>(i));
+    BeginChecksumWrite(pages_[batch[i]].page_id_);
+    writes.push_back(disk_manager_->WritePageAsync(pages_[batch[i]].page_id_, buffer));
+  }
+  if (!batch.empty()) {
+    disk_manager_->SubmitAsync();
+  }
+  for (size_t i = 0; i < batch.size(); ++i) {
+    Page *page = &pages_[batch[i]];
+    if (writes[i].get()) {
+      StoreChecksum(page->page_id_, buffers.GetFrame(static_cast<frame_id_t>(i)));
+      metrics_.Add(BPM_FLUSHED_PAGES);
+    } else {
+      page->is_dirty_ = true;
+    }
+  }
+  FinishWriteBacks(batch);
+  for (frame_id_t frame_id : batch) {
+    DropPin(&pages_[frame_id]);
+  }
+  return batch.size();
+}
+
+bool BufferPoolManagerInstance::PrepareBackgroundWrite(frame_id_t frame_id, bool write_referenced, char *buffer) {
+  Page *page = &pages_[frame_id];
+  auto lock = LockLatch();
+  // A page with a write in flight is left to that write, and to the next round if it was dirtied again.
+  if (frame_states_[frame_id] != FrameState::READY || page->pin_count_ != 0 || !page->is_dirty_ ||
+      frame_writing_[frame_id] || (page->ref_bit_ && !write_referenced)) {
+    return false;
+  }
+  // Same as FlushPgImp: the pin keeps the page in its frame until the write completed. Otherwise the frame could be
+  // evicted as clean and the page read back from disk before the write lands.
+  AddPin(page);
+  frame_writing_[frame_id] = true;
+  lock.unlock();
+
+  // The contents are copied out, so that no page latch is held while waiting for the whole batch.
+  page->RLatch();
+  const bool write =
+      !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
+  if (write) {
+    page->is_dirty_ = false;
+    memcpy(buffer, page->GetData(), PAGE_SIZE);
+  }
+  page->RUnlatch();
+  if (!write) {
+    FinishWriteBacks({frame_id});
+    DropPin(page);
+  }
+  return write;
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage(bool *reused) {
+  std::scoped_lock lock{allocation_latch_};
+  page_id_t page_id;
+  // Free ids in slots a parallel BPM moved to another instance since they were freed are not reused.
+  *reused = free_page_map_->Reuse(&page_id, [this](page_id_t free_page_id) { return CanAllocate(free_page_id); });
+  if (*reused) {
+    return page_id;
+  }
+  if (owns_page_) {
+    // The ids this BPI owns are decided by the parallel BPM; hand out the next one.
+    page_id = next_page_id_;
+    while (!owns_page_(page_id)) {
+      page_id++;
+    }
+    next_page_id_ = page_id + 1;
+  } else {
+    page_id = next_page_id_;
+    next_page_id_ += num_instances_;
+    ValidatePageId(page_id);
+  }
+  free_page_map_->Reserve(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock lock{allocation_latch_};
+  // Ids that were never handed out, or that this BPI does not hand out, are left alone.
+  if (page_id < 0 || page_id >= next_page_id_ || !CanAllocate(page_id)) {
+    return;
+  }
+  // A later page under the same id must not be checked against the checksum of this one.
+  disk_manager_->ClearChecksum(page_id);
+  free_page_map_->Free(page_id);
+}
+
+bool BufferPoolManagerInstance::CanAllocate(page_id_t page_id) const {
+  if (owns_page_) {
+    return owns_page_(page_id);
+  }
+  return static_cast<uint32_t>(page_id) % num_instances_ == instance_index_;
 }
 
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
@@ -14,16 +14,62 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages),
+      evictable_(std::make_unique<std::atomic<bool>[]>(num_pages)),
+      ref_(std::make_unique<std::atomic<bool>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    evictable_[i].store(false, std::memory_order_relaxed);
+    ref_[i].store(false, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // Two full sweeps find a victim if the set of evictable frames stays put: the first clears reference bits, the
+  // second claims a frame. The third sweep only absorbs frames that are concurrently unpinned again.
+  for (size_t step = 0; step < 3 * num_pages_; ++step) {
+    if (size_ == 0) {
+      return false;
+    }
+    const size_t frame = hand_.fetch_add(1, std::memory_order_relaxed) % num_pages_;
+    if (!evictable_[frame].load(std::memory_order_relaxed)) {
+      continue;
+    }
+    if (ref_[frame].load(std::memory_order_relaxed)) {
+      ref_[frame].store(false, std::memory_order_relaxed);
+      continue;
+    }
+    bool evictable = true;
+    if (evictable_[frame].compare_exchange_strong(evictable, false)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (evictable_[frame_id].exchange(false)) {
+    size_--;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  ref_[frame_id].store(true, std::memory_order_relaxed);
+  if (!evictable_[frame_id].exchange(true)) {
+    size_++;
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  if (access_type == AccessType::Scan) {
+    ref_[frame_id].store(false, std::memory_order_relaxed);
+  }
+}
+
+size_t ClockReplacer::Size() { return size_; }
 
 }  // namespace bustub
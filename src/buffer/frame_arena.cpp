@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+size_t RoundUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+void *MapAnonymous(size_t size, int flags) {
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames) {
+  const size_t size = num_frames * PAGE_SIZE;
+  if (size >= HUGE_PAGE_SIZE) {
+    mapped_size_ = RoundUp(size, HUGE_PAGE_SIZE);
+
+    // Huge pages reserved by the administrator first; most systems have none.
+    void *ptr = MapAnonymous(mapped_size_, MAP_HUGETLB);
+    if (ptr != nullptr) {
+      data_ = static_cast<char *>(ptr);
+      backing_ = Backing::HUGETLB;
+      return;
+    }
+
+    // Then transparent huge pages, which the kernel can only use for memory aligned to a huge page: map one huge
+    // page more than needed and trim both ends.
+    ptr = MapAnonymous(mapped_size_ + HUGE_PAGE_SIZE, 0);
+    if (ptr == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map " + std::to_string(size) + " bytes of frames");
+    }
+    const auto start = reinterpret_cast<uintptr_t>(ptr);
+    const uintptr_t aligned = RoundUp(start, HUGE_PAGE_SIZE);
+    if (aligned > start) {
+      munmap(ptr, aligned - start);
+    }
+    if (start + HUGE_PAGE_SIZE > aligned) {
+      munmap(reinterpret_cast<void *>(aligned + mapped_size_), start + HUGE_PAGE_SIZE - aligned);
+    }
+    data_ = reinterpret_cast<char *>(aligned);
+    // Without transparent huge page support the advice fails and the arena is backed by normal pages.
+    backing_ = madvise(data_, mapped_size_, MADV_HUGEPAGE) == 0 ? Backing::TRANSPARENT_HUGE_PAGES : Backing::PAGES;
+    return;
+  }
+
+  // mmap returns memory aligned to the system page size, which PAGE_SIZE is a multiple of.
+  mapped_size_ = RoundUp(size == 0 ? PAGE_SIZE : size, PAGE_SIZE);
+  data_ = static_cast<char *>(MapAnonymous(mapped_size_, 0));
+  if (data_ == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map " + std::to_string(size) + " bytes of frames");
+  }
+}
+
+FrameArena::~FrameArena() { munmap(data_, mapped_size_); }
+
+}  // namespace bustub
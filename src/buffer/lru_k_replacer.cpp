@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <chrono>  // NOLINT
+#include <limits>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : num_pages_(num_pages),
+      k_(k),
+      evictable_(std::make_unique<std::atomic<bool>[]>(num_pages)),
+      access_count_(std::make_unique<std::atomic<size_t>[]>(num_pages)),
+      history_(std::make_unique<std::atomic<uint64_t>[]>(num_pages * k)) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to remember at least one access");
+  for (size_t i = 0; i < num_pages_; ++i) {
+    evictable_[i].store(false, std::memory_order_relaxed);
+    access_count_[i].store(0, std::memory_order_relaxed);
+  }
+  for (size_t i = 0; i < num_pages_ * k_; ++i) {
+    history_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+uint64_t LRUKReplacer::OldestAccess(size_t frame_id, size_t access_count) const {
+  if (access_count == 0) {
+    return 0;
+  }
+  // Until the ring wraps the oldest access is in slot 0; after that it is the slot the next access overwrites.
+  const size_t slot = access_count < k_ ? 0 : access_count % k_;
+  return history_[frame_id * k_ + slot].load(std::memory_order_relaxed);
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(victim_latch_);
+  while (size_ > 0) {
+    size_t victim = num_pages_;
+    bool victim_infinite = false;
+    uint64_t victim_oldest = std::numeric_limits<uint64_t>::max();
+    for (size_t frame = 0; frame < num_pages_; ++frame) {
+      if (!evictable_[frame].load(std::memory_order_relaxed)) {
+        continue;
+      }
+      const size_t access_count = access_count_[frame].load(std::memory_order_relaxed);
+      const bool infinite = access_count < k_;
+      const uint64_t oldest = OldestAccess(frame, access_count);
+      if (victim == num_pages_ || (infinite && !victim_infinite) ||
+          (infinite == victim_infinite && oldest < victim_oldest)) {
+        victim = frame;
+        victim_infinite = infinite;
+        victim_oldest = oldest;
+      }
+    }
+    if (victim == num_pages_) {
+      return false;
+    }
+
+    // The frame may have been pinned since the scan; if so, look again.
+    bool evictable = true;
+    if (evictable_[victim].compare_exchange_strong(evictable, false)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(victim);
+      return true;
+    }
+  }
+  return false;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (evictable_[frame_id].exchange(false)) {
+    size_--;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (!evictable_[frame_id].exchange(true)) {
+    size_++;
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  Pin(frame_id);
+  access_count_[frame_id].store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < k_; ++i) {
+    history_[frame_id * k_ + i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  if (access_type == AccessType::Scan) {
+    return;
+  }
+  // A steady clock reading costs no shared-memory write, unlike a global logical counter.
+  const auto now = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  const size_t access_count = access_count_[frame_id].fetch_add(1, std::memory_order_relaxed);
+  history_[frame_id * k_ + access_count % k_].store(now, std::memory_order_relaxed);
+}
+
+size_t LRUKReplacer::Size() { return size_; }
+
+}  // namespace bustub
@@ -46,10 +46,12 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
     return false;
   } 
   
-  *frame_id = tail_->prev_->l_data_;
+  FrameListNode *victim = tail_->prev_;
+  *frame_id = victim->l_data_;
   lru_map_.erase(*frame_id);
   size_ --;
-  Remove(tail_->prev_);
+  Remove(victim);
+  delete victim;
   return true;
   // shall we remove ?? who has the priviledge to change data member of LRU?? remove, insert? and what/??
 }
@@ -66,6 +68,7 @@ void LRUReplacer::Pin(frame_id_t frame_id) {
   auto node2remove = lru_map_[frame_id];
 
   Remove(node2remove);
+  delete node2remove;
   lru_map_.erase(frame_id);
   size_ --;
 }
@@ -75,17 +78,30 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   // put it into map;
   //
   // insert into map, list, ?? how to solve it??
+  std::lock_guard<std::mutex> guard(frame_list_mutex_);
   if (lru_map_.count(frame_id) != 0) {
     return;
   }
   auto node2insert = new FrameListNode(frame_id);
-  std::lock_guard<std::mutex> guard(frame_list_mutex_);
   lru_map_.insert({frame_id, node2insert});
   size_ ++;
   Insert(node2insert);
   //    delete node2insert;
 }
 
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  if (access_type != AccessType::Scan) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(frame_list_mutex_);
+  auto it = lru_map_.find(frame_id);
+  if (it == lru_map_.end()) {
+    return;
+  }
+  Remove(it->second);
+  InsertAtTail(it->second);
+}
+
 size_t LRUReplacer::Size() { return size_; }
 
 }  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(DiskManager *disk_manager) {
+  size_t size;
+  // The mapping is read-only; Page hands out char * only because buffer pool pages are writable.
+  mapping_ = const_cast<char *>(disk_manager->MapReadOnly(&size));
+  if (mapping_ == nullptr) {
+    throw Exception("can't map db file");
+  }
+  num_pages_ = size / PAGE_SIZE;
+  // Value-initialized, so every view starts out as nullptr without touching a page per view up front.
+  page_views_.reset(new std::atomic<Page *>[num_pages_]());
+}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    delete page_views_[i].load(std::memory_order_relaxed);
+  }
+}
+
+Page *MmapBufferPoolManager::GetPageView(page_id_t page_id) {
+  Page *page = page_views_[page_id].load(std::memory_order_acquire);
+  if (page != nullptr) {
+    return page;
+  }
+  auto view = std::make_unique<Page>();
+  view->data_ = mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+  view->page_id_ = page_id;
+  // Another thread may have created the view in the meantime; then that one is used.
+  if (page_views_[page_id].compare_exchange_strong(page, view.get(), std::memory_order_acq_rel)) {
+    page = view.release();
+  }
+  return page;
+}
+
+Page *MmapBufferPoolManager::FetchPgImp(page_id_t page_id, AccessType access_type) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return nullptr;
+  }
+  Page *page = GetPageView(page_id);
+  page->pin_count_++;
+  return page;
+}
+
+bool MmapBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return false;
+  }
+  Page *page = page_views_[page_id].load(std::memory_order_acquire);
+  if (page == nullptr) {
+    return false;
+  }
+  // Refused before the pin is dropped, so that the caller still holds the page it failed to unpin.
+  if (is_dirty) {
+    LOG_WARN("page %d of a read-only buffer pool was unpinned as dirty", page_id);
+    return false;
+  }
+  int pin_count = page->pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  return true;
+}
+
+OptimisticPageGuard MmapBufferPoolManager::FetchPageOptimistic(page_id_t page_id) {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_) {
+    return {};
+  }
+  Page *page = GetPageView(page_id);
+  const uint64_t version = page->GetVersion();
+  // Odd only while somebody holds the write latch, which is all a write to a read-only page can be.
+  if ((version & 1) != 0) {
+    return {};
+  }
+  return {page, version};
+}
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(2), hash_shift_(63) {
+  while (capacity_ < 2 * num_frames) {
+    capacity_ <<= 1;
+    hash_shift_--;
+  }
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; ++i) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+size_t PageTable::HomeSlot(page_id_t page_id) const {
+  // Fibonacci hashing spreads the dense, strided page ids handed out by the buffer pool over the whole table.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                             hash_shift_);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  const size_t mask = capacity_ - 1;
+  for (size_t i = HomeSlot(page_id), probes = 0; probes < capacity_; i = (i + 1) & mask, ++probes) {
+    const uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (SlotPageId(slot) == page_id) {
+      *frame_id = SlotFrameId(slot);
+      return true;
+    }
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot map the invalid page id");
+  const size_t mask = capacity_ - 1;
+  size_t i = HomeSlot(page_id);
+  while (true) {
+    const uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || SlotPageId(slot) == page_id) {
+      if (slot == EMPTY_SLOT) {
+        BUSTUB_ASSERT(size_ + 1 < capacity_, "page table overflow");
+        size_++;
+      }
+      slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+bool PageTable::Remove(page_id_t page_id) {
+  const size_t mask = capacity_ - 1;
+  size_t hole = HomeSlot(page_id);
+  while (true) {
+    const uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (SlotPageId(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask;
+  }
+
+  // Backward-shift deletion: move every following entry of the probe run that would no longer be reachable across
+  // the hole back into it, so that the table never needs tombstones.
+  size_t next = hole;
+  while (true) {
+    next = (next + 1) & mask;
+    const uint64_t slot = slots_[next].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    const size_t home = HomeSlot(SlotPageId(slot));
+    const bool reachable = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+    if (reachable) {
+      continue;
+    }
+    slots_[hole].store(slot, std::memory_order_release);
+    hole = next;
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+}  // namespace bustub
@@ -12,85 +12,393 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "common/exception.h"
+
 namespace bustub {
 
-ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
-  // how to save an array of BufferPoolManager???
+namespace {
+
+/** Hands out the pool ids. */
+std::atomic<uint64_t> next_pool_id{0};
+
+/** A thread's round robin cursor over the instances of the pool it last created a page in. */
+struct AllocationCursor {
+  uint64_t pool_id_ = UINT64_MAX;
+  uint32_t next_index_ = 0;
+};
 
+thread_local AllocationCursor allocation_cursor;
+
+}  // namespace
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_id_(next_pool_id.fetch_add(1)),
+      routes_(BPM_ROUTING_SLOTS),
+      pool_size_(pool_size),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      replacer_type_(replacer_type) {
+  BUSTUB_ASSERT(num_instances > 0 && num_instances <= BPM_ROUTING_SLOTS, "Invalid number of BPIs");
+  // Slot s starts out with instance s % num_instances, so that page ids are dealt out round robin.
+  for (size_t slot = 0; slot < routes_.size(); ++slot) {
+    routes_[slot] = slot % num_instances;
+  }
   for (size_t i = 0; i < num_instances; ++i) {
-    bpmi_.push_back(new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager));
+    bpmi_.push_back(CreateInstance(i));
   }
-
-  // Allocate and create individual BufferPoolManagerInstances
+  SyncNextPageIds();
 }
 
+ParallelBufferPoolManager::ParallelBufferPoolManager(const BustubConfig &config, DiskManager *disk_manager,
+                                                     LogManager *log_manager)
+    : ParallelBufferPoolManager(config.num_instances_, config.buffer_pool_size_, disk_manager, log_manager,
+                                config.replacer_type_) {}
+
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
 ParallelBufferPoolManager::~ParallelBufferPoolManager() {
-  for (auto& bpmi : bpmi_) {
+  read_ahead_worker_.Stop();
+  for (auto &bpmi : bpmi_) {
+    delete bpmi;
+  }
+  for (auto &bpmi : retired_bpmi_) {
     delete bpmi;
   }
 }
 
+BufferPoolManagerInstance *ParallelBufferPoolManager::CreateInstance(uint32_t instance_index) {
+  // An instance retired with the same index is brought back, so that there is never more than one retired instance
+  // per index. It holds no pages, and routes to it by index the same way as before.
+  BufferPoolManagerInstance *bpmi;
+  auto retired = std::find_if(retired_bpmi_.begin(), retired_bpmi_.end(),
+                              [instance_index](auto *b) { return b->instance_index_ == instance_index; });
+  if (retired != retired_bpmi_.end()) {
+    bpmi = *retired;
+    retired_bpmi_.erase(retired);
+    bpmi->free_page_map_ = disk_manager_->OpenFreePageMap(instance_index);
+  } else {
+    bpmi = new BufferPoolManagerInstance(pool_size_, instance_index + 1, instance_index, disk_manager_, log_manager_,
+                                         replacer_type_);
+    bpmi->owns_page_ = [this, instance_index](page_id_t page_id) { return Route(page_id) == instance_index; };
+  }
+  bpmi->SetPageChecksums(page_checksums_);
+  // Without a stride, the instance continues from where its free page map says, not from its index.
+  bpmi->next_page_id_ = bpmi->free_page_map_->GetNextPageId();
+  return bpmi;
+}
+
+void ParallelBufferPoolManager::SyncNextPageIds() {
+  page_id_t next_page_id = 0;
+  for (auto *bpmi : bpmi_) {
+    next_page_id = std::max<page_id_t>(next_page_id, bpmi->next_page_id_);
+  }
+  for (auto *bpmi : bpmi_) {
+    bpmi->next_page_id_ = next_page_id;
+  }
+}
+
 size_t ParallelBufferPoolManager::GetPoolSize() {
   // Get size of all BufferPoolManagerInstances
-  return bpmi_[0]->GetPoolSize() * bpmi_.size();
+  resize_latch_.RLock();
+  const size_t pool_size = pool_size_ * bpmi_.size();
+  resize_latch_.RUnlock();
+  return pool_size;
+}
+
+size_t ParallelBufferPoolManager::GetNumInstances() {
+  resize_latch_.RLock();
+  const size_t num_instances = bpmi_.size();
+  resize_latch_.RUnlock();
+  return num_instances;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (const auto &instance_stats : GetInstanceStats()) {
+    stats += instance_stats;
+  }
+  return stats;
+}
+
+std::vector<BufferPoolStats> ParallelBufferPoolManager::GetInstanceStats() {
+  std::vector<BufferPoolStats> stats;
+  resize_latch_.RLock();
+  stats.reserve(bpmi_.size());
+  for (auto *bpmi : bpmi_) {
+    stats.push_back(bpmi->GetStats());
+  }
+  resize_latch_.RUnlock();
+  return stats;
+}
+
+void ParallelBufferPoolManager::ReadAhead(page_id_t page_id, next_page_fn next_page, size_t num_pages) {
+  read_ahead_worker_.Schedule(page_id, next_page, num_pages);
+}
+
+OptimisticPageGuard ParallelBufferPoolManager::FetchPageOptimistic(page_id_t page_id) {
+  resize_latch_.RLock();
+  OptimisticPageGuard guard = bpmi_[Route(page_id)]->FetchPageOptimistic(page_id);
+  resize_latch_.RUnlock();
+  return guard;
+}
+
+void ParallelBufferPoolManager::RunBackgroundWriter() {
+  const std::lock_guard<std::mutex> guard(resize_mutex_);
+  bg_writer_running_ = true;
+  for (auto *bpmi : bpmi_) {
+    bpmi->RunBackgroundWriter();
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  const std::lock_guard<std::mutex> guard(resize_mutex_);
+  bg_writer_running_ = false;
+  for (auto *bpmi : bpmi_) {
+    bpmi->StopBackgroundWriter();
+  }
+}
+
+void ParallelBufferPoolManager::SetPageChecksums(bool enabled) {
+  const std::lock_guard<std::mutex> guard(resize_mutex_);
+  page_checksums_ = enabled;
+  for (auto *bpmi : bpmi_) {
+    bpmi->SetPageChecksums(enabled);
+  }
+}
+
+bool ParallelBufferPoolManager::Resize(size_t num_instances) {
+  BUSTUB_ASSERT(num_instances > 0 && num_instances <= BPM_ROUTING_SLOTS, "Invalid number of BPIs");
+  // Only resizes change routes_ and bpmi_, so while holding resize_mutex_ they can be read without resize_latch_.
+  const std::lock_guard<std::mutex> guard(resize_mutex_);
+  const size_t num_planned = std::max(num_instances, bpmi_.size());
+
+  // 1. Plan: every instance below num_instances should own an even share of the slots, and the rest none. Slots
+  //    only leave instances that own too many, so that as few pages as possible change instance.
+  auto target = [num_instances](size_t index) -> size_t {
+    if (index >= num_instances) {
+      return 0;
+    }
+    return BPM_ROUTING_SLOTS / num_instances + (index < BPM_ROUTING_SLOTS % num_instances ? 1 : 0);
+  };
+  std::vector<size_t> owned(num_planned, 0);
+  for (uint32_t route : routes_) {
+    owned[route]++;
+  }
+  std::vector<std::pair<size_t, uint32_t>> moves;  // (slot, new owner)
+  uint32_t receiver = 0;
+  for (size_t slot = 0; slot < routes_.size(); ++slot) {
+    const uint32_t owner = routes_[slot];
+    if (owned[owner] > target(owner)) {
+      while (owned[receiver] >= target(receiver)) {
+        receiver++;
+      }
+      moves.emplace_back(slot, receiver);
+      owned[owner]--;
+      owned[receiver]++;
+    }
+  }
+  std::vector<bool> moving(routes_.size(), false);
+  for (const auto &move : moves) {
+    moving[move.first] = true;
+  }
+  auto in_moving_slot = [&moving](page_id_t page_id) {
+    return moving[static_cast<uint32_t>(page_id) % BPM_ROUTING_SLOTS];
+  };
+
+  // 2. Write back the dirty pages that are about to move while the pool is still in use, so that little is left to
+  //    write once it is not.
+  for (auto *bpmi : bpmi_) {
+    bpmi->FlushDirtyPages(in_moving_slot);
+  }
+
+  // 3. With every other operation held off, evict the moving pages from their old instances and switch the routes.
+  resize_latch_.WLock();
+  while (bpmi_.size() < num_instances) {
+    bpmi_.push_back(CreateInstance(bpmi_.size()));
+    if (bg_writer_running_) {
+      bpmi_.back()->RunBackgroundWriter();
+    }
+  }
+  std::vector<bool> stuck(routes_.size(), false);
+  for (auto *bpmi : bpmi_) {
+    for (page_id_t page_id : bpmi->GetResidentPageIds()) {
+      if (in_moving_slot(page_id) && !bpmi->EvictPgImp(page_id)) {
+        stuck[static_cast<uint32_t>(page_id) % BPM_ROUTING_SLOTS] = true;
+      }
+    }
+  }
+  bool complete = true;
+  for (const auto &[slot, new_owner] : moves) {
+    if (stuck[slot]) {
+      complete = false;
+    } else {
+      routes_[slot] = new_owner;
+    }
+  }
+
+  // Retire the instances past num_instances that no longer own any slot. Their ids may now be handed out by other
+  // instances, so every instance continues allocating after the highest id handed out so far.
+  std::fill(owned.begin(), owned.end(), 0);
+  for (uint32_t route : routes_) {
+    owned[route]++;
+  }
+  SyncNextPageIds();
+  while (bpmi_.size() > num_instances && owned[bpmi_.size() - 1] == 0) {
+    BufferPoolManagerInstance *bpmi = bpmi_.back();
+    bpmi_.pop_back();
+    // Holds no pages any more. Its free page map is closed now, as an instance with the same index may open it again.
+    bpmi->StopBackgroundWriter();
+    bpmi->free_page_map_.reset();
+    retired_bpmi_.push_back(bpmi);
+  }
+  starting_index_ = 0;
+  complete = complete && bpmi_.size() == num_instances;
+  resize_latch_.WUnlock();
+  return complete;
 }
 
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  return bpmi_[page_id % bpmi_.size()];
+  return bpmi_[Route(page_id)];
 }
 
-Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
+Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, AccessType access_type) {
   // Fetch page for page_id from responsible BufferPoolManagerInstance
+  resize_latch_.RLock();
+  Page *page;
+  try {
+    page = GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+  } catch (const Exception &) {
+    resize_latch_.RUnlock();
+    throw;
+  }
+  resize_latch_.RUnlock();
+  return page;
+}
+
+std::vector<Page *> ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids,
+                                                          AccessType access_type) {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  resize_latch_.RLock();
+  // Group the positions of the pages by instance, keeping their order within each group.
+  std::vector<std::vector<size_t>> positions(bpmi_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    positions[Route(page_ids[i])].push_back(i);
+  }
+
+  // The I/O of every group is submitted before any of it is waited for, so that the groups overlap without a
+  // thread of their own.
+  std::vector<std::pair<uint32_t, BufferPoolManagerInstance::PendingFetch>> fetches;
+  for (uint32_t instance = 0; instance < positions.size(); ++instance) {
+    if (positions[instance].empty()) {
+      continue;
+    }
+    std::vector<page_id_t> group_ids;
+    group_ids.reserve(positions[instance].size());
+    for (size_t i : positions[instance]) {
+      group_ids.push_back(page_ids[i]);
+    }
+    fetches.emplace_back(instance, bpmi_[instance]->StartFetchPages(group_ids, access_type));
+  }
 
-  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+  // Every started fetch is finished, as it holds frames; a group that fails makes the whole batch fail afterwards.
+  std::exception_ptr error;
+  for (auto &[instance, fetch] : fetches) {
+    try {
+      const std::vector<Page *> group_pages = bpmi_[instance]->FinishFetchPages(&fetch);
+      for (size_t j = 0; j < group_pages.size(); ++j) {
+        pages[positions[instance][j]] = group_pages[j];
+      }
+    } catch (const Exception &) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    for (size_t i = 0; i < pages.size(); ++i) {
+      if (pages[i] != nullptr) {
+        GetBufferPoolManager(page_ids[i])->UnpinPage(page_ids[i], false);
+      }
+    }
+    resize_latch_.RUnlock();
+    std::rethrow_exception(error);
+  }
+  resize_latch_.RUnlock();
+  return pages;
 }
 
 bool ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
   // Unpin page_id from responsible BufferPoolManagerInstance
-  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+  resize_latch_.RLock();
+  const bool unpinned = GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+  resize_latch_.RUnlock();
+  return unpinned;
 }
 
 bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
   // Flush page_id from responsible BufferPoolManagerInstance
-  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+  resize_latch_.RLock();
+  const bool flushed = GetBufferPoolManager(page_id)->FlushPage(page_id);
+  resize_latch_.RUnlock();
+  return flushed;
 }
 
 Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
   // create new page. We will request page allocation in a round robin manner from the underlying
   // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
-
-  size_t limit = bpmi_.size();
-  uint32_t old_starting_index = starting_index_;
-  Page *newpage;
-  starting_index_++;
-
-  for (size_t i = 0; i < limit; i++) {
-    newpage = bpmi_[(old_starting_index + i) % limit]->NewPgImp(page_id);
-    if (newpage != nullptr) {
-      return newpage;
-    }
+  // 1.   Every thread goes round robin over the instances on a cursor of its own, so that concurrent allocations
+  //      neither write to a shared cursor nor queue up on the same instance latch.
+  // 2.   If that instance is full, probe the others once, starting at the shared starting index. Instances whose
+  //      frames are all pinned are skipped without taking their latches.
+  resize_latch_.RLock();
+  const size_t num_instances = bpmi_.size();
+  if (allocation_cursor.pool_id_ != pool_id_) {
+    allocation_cursor = {pool_id_, starting_index_.fetch_add(1, std::memory_order_relaxed)};
+  }
+  BufferPoolManagerInstance *preferred = bpmi_[allocation_cursor.next_index_++ % num_instances];
+  Page *newpage = nullptr;
+  if (preferred->GetNumUnpinnedFrames() > 0) {
+    newpage = preferred->NewPgImp(page_id);
   }
 
-  return nullptr;
+  const uint32_t start = newpage == nullptr ? starting_index_.fetch_add(1, std::memory_order_relaxed) : 0;
+  for (size_t i = 0; i < num_instances && newpage == nullptr; i++) {
+    BufferPoolManagerInstance *bpmi = bpmi_[(start + i) % num_instances];
+    if (bpmi != preferred && bpmi->GetNumUnpinnedFrames() > 0) {
+      newpage = bpmi->NewPgImp(page_id);
+    }
+  }
+  resize_latch_.RUnlock();
+  return newpage;
 }
 
 bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
   // Delete page_id from responsible BufferPoolManagerInstance
-  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+  resize_latch_.RLock();
+  const bool deleted = GetBufferPoolManager(page_id)->DeletePage(page_id);
+  resize_latch_.RUnlock();
+  return deleted;
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
-  for (auto& bpmi : bpmi_) {
-    bpmi->FlushAllPgsImp();
+  // flush all pages from all BufferPoolManagerInstances, every instance on its own thread
+  resize_latch_.RLock();
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < bpmi_.size(); ++i) {
+    threads.emplace_back([bpmi = bpmi_[i]] { bpmi->FlushAllPgsImp(); });
+  }
+  bpmi_[0]->FlushAllPgsImp();
+  for (auto &thread : threads) {
+    thread.join();
   }
+  resize_latch_.RUnlock();
 }
 
 }  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_worker.cpp
+//
+// Identification: src/buffer/read_ahead_worker.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead_worker.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+void ReadAheadWorker::Schedule(page_id_t page_id, BufferPoolManager::next_page_fn next_page, size_t num_pages) {
+  if (page_id == INVALID_PAGE_ID || num_pages == 0) {
+    return;
+  }
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    if (stopped_) {
+      return;
+    }
+    if (thread_ == nullptr) {
+      thread_ = new std::thread(&ReadAheadWorker::Run, this);
+    }
+    if (requests_.size() == MAX_PENDING_REQUESTS) {
+      requests_.pop_front();
+    }
+    requests_.push_back(Request{page_id, next_page, num_pages});
+  }
+  cv_.notify_one();
+}
+
+void ReadAheadWorker::Stop() {
+  std::thread *thread;
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    stopped_ = true;
+    requests_.clear();
+    thread = thread_;
+    thread_ = nullptr;
+  }
+  if (thread != nullptr) {
+    cv_.notify_all();
+    thread->join();
+    delete thread;
+  }
+}
+
+void ReadAheadWorker::Run() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopped_ || !requests_.empty(); });
+    if (stopped_) {
+      return;
+    }
+    const Request request = requests_.front();
+    requests_.pop_front();
+    lock.unlock();
+    Load(request);
+    lock.lock();
+  }
+}
+
+void ReadAheadWorker::Load(const Request &request) {
+  // Pages of the chain that are already resident are cheap hits; they are only visited to find the page after them.
+  page_id_t page_id = request.page_id_;
+  for (size_t i = 0; i < request.num_pages_ && page_id != INVALID_PAGE_ID; ++i) {
+    Page *page;
+    try {
+      page = bpm_->FetchPage(page_id, AccessType::Scan);
+    } catch (const Exception &) {
+      // A corrupt page ends the chain here; the fetch that needs it reports it.
+      return;
+    }
+    if (page == nullptr) {
+      return;
+    }
+    page->RLatch();
+    const page_id_t next_page_id = request.next_page_(page);
+    page->RUnlatch();
+    bpm_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bustub_config.cpp
+//
+// Identification: src/common/bustub_config.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/bustub_config.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** Parse the environment variable name as a size, leaving value untouched if it is not set. */
+void ReadSize(const char *name, size_t *value) {
+  const char *text = std::getenv(name);
+  if (text == nullptr) {
+    return;
+  }
+  char *end;
+  const unsigned long long parsed = std::strtoull(text, &end, 10);  // NOLINT
+  if (end == text || *end != '\0' || text[0] == '-') {
+    throw Exception(ExceptionType::CONVERSION, std::string(name) + " is not a size: " + text);
+  }
+  *value = static_cast<size_t>(parsed);
+}
+
+}  // namespace
+
+BustubConfig BustubConfig::FromEnvironment() {
+  BustubConfig config;
+  ReadSize("BUSTUB_BUFFER_POOL_SIZE", &config.buffer_pool_size_);
+  ReadSize("BUSTUB_BUFFER_POOL_INSTANCES", &config.num_instances_);
+  ReadSize("BUSTUB_LOG_BUFFER_SIZE", &config.log_buffer_size_);
+  if (const char *replacer = std::getenv("BUSTUB_REPLACER"); replacer != nullptr) {
+    const std::string name(replacer);
+    if (name == "lru") {
+      config.replacer_type_ = ReplacerType::LRU;
+    } else if (name == "clock") {
+      config.replacer_type_ = ReplacerType::CLOCK;
+    } else if (name == "lru-k") {
+      config.replacer_type_ = ReplacerType::LRU_K;
+    } else {
+      throw Exception(ExceptionType::CONVERSION, "BUSTUB_REPLACER is not one of lru, clock, lru-k: " + name);
+    }
+  }
+  config.Validate();
+  return config;
+}
+
+void BustubConfig::Validate() const {
+  if (buffer_pool_size_ == 0) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "buffer pool size must be at least one frame");
+  }
+  if (num_instances_ == 0) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "there must be at least one buffer pool instance");
+  }
+  // A log record can carry a whole tuple, so the log buffer must be able to hold at least a page.
+  if (log_buffer_size_ < static_cast<size_t>(PAGE_SIZE)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "log buffer size must be at least one page");
+  }
+}
+
+}  // namespace bustub
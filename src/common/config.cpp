@@ -20,4 +20,18 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bg_writer_delay = std::chrono::milliseconds(20);
+
+std::atomic<size_t> bg_writer_max_pages(64);
+
+std::atomic<double> bg_writer_clean_target(0.25);
+
+std::atomic<bool> enable_io_uring(true);
+
+std::atomic<bool> enable_direct_io(false);
+
+std::atomic<bool> enable_page_compression(false);
+
+std::atomic<bool> enable_page_checksums(false);
+
 }  // namespace bustub
@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The CRC-32C polynomial, bit-reversed. */
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+/** Length of each of the three interleaved streams: a multiple of 8, and three of them fit into a page. */
+constexpr size_t STREAM_SIZE = 1360;
+
+/** Both supported architectures are little-endian, which the slicing table relies on. */
+inline uint64_t Load64(const char *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+/**
+ * The tables work on the CRC register, without the inversions before and after. slice_[k][b] is the register after
+ * byte b and k zero bytes. shift_ advances a register over STREAM_SIZE zero bytes, one byte of it at a time: that is a
+ * linear map, so the four lookups can be combined with xor.
+ */
+struct Tables {
+  uint32_t slice_[8][256];
+  uint32_t shift_[4][256];
+
+  Tables() {
+    for (uint32_t b = 0; b < 256; b++) {
+      uint32_t crc = b;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+      }
+      slice_[0][b] = crc;
+    }
+    for (int k = 1; k < 8; k++) {
+      for (uint32_t b = 0; b < 256; b++) {
+        slice_[k][b] = (slice_[k - 1][b] >> 8) ^ slice_[0][slice_[k - 1][b] & 0xff];
+      }
+    }
+
+    // Each bit of the register is shifted on its own, and the shift of a byte is the xor of those of its bits.
+    uint32_t shifted_bits[32];
+    for (int bit = 0; bit < 32; bit++) {
+      uint32_t crc = uint32_t{1} << bit;
+      for (size_t i = 0; i < STREAM_SIZE; i++) {
+        crc = (crc >> 8) ^ slice_[0][crc & 0xff];
+      }
+      shifted_bits[bit] = crc;
+    }
+    for (int k = 0; k < 4; k++) {
+      for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = 0;
+        for (int bit = 0; bit < 8; bit++) {
+          if (((b >> bit) & 1) != 0) {
+            crc ^= shifted_bits[8 * k + bit];
+          }
+        }
+        shift_[k][b] = crc;
+      }
+    }
+  }
+
+  /** @return the register crc advanced over STREAM_SIZE zero bytes */
+  uint32_t Shift(uint32_t crc) const {
+    return shift_[0][crc & 0xff] ^ shift_[1][(crc >> 8) & 0xff] ^ shift_[2][(crc >> 16) & 0xff] ^ shift_[3][crc >> 24];
+  }
+};
+
+const Tables &GetTables() {
+  static const Tables tables;
+  return tables;
+}
+
+uint32_t TableUpdate(uint32_t crc, const char *data, size_t size) {
+  const Tables &tables = GetTables();
+  const auto &slice = tables.slice_;
+  while (size >= 8) {
+    const uint64_t word = Load64(data) ^ crc;
+    crc = slice[7][word & 0xff] ^ slice[6][(word >> 8) & 0xff] ^ slice[5][(word >> 16) & 0xff] ^
+          slice[4][(word >> 24) & 0xff] ^ slice[3][(word >> 32) & 0xff] ^ slice[2][(word >> 40) & 0xff] ^
+          slice[1][(word >> 48) & 0xff] ^ slice[0][word >> 56];
+    data += 8;
+    size -= 8;
+  }
+  for (; size > 0; size--) {
+    crc = (crc >> 8) ^ slice[0][(crc ^ static_cast<uint8_t>(*data++)) & 0xff];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+#define BUSTUB_CRC32C_TARGET __attribute__((target("sse4.2")))
+
+BUSTUB_CRC32C_TARGET inline uint32_t Step64(uint32_t crc, uint64_t word) {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+}
+BUSTUB_CRC32C_TARGET inline uint32_t Step8(uint32_t crc, uint8_t byte) { return _mm_crc32_u8(crc, byte); }
+bool HasHardware() { return __builtin_cpu_supports("sse4.2") != 0; }
+
+#elif defined(__aarch64__)
+
+#if defined(__clang__)
+#define BUSTUB_CRC32C_TARGET __attribute__((target("crc")))
+#else
+#define BUSTUB_CRC32C_TARGET __attribute__((target("+crc")))
+#endif
+
+BUSTUB_CRC32C_TARGET inline uint32_t Step64(uint32_t crc, uint64_t word) { return __crc32cd(crc, word); }
+BUSTUB_CRC32C_TARGET inline uint32_t Step8(uint32_t crc, uint8_t byte) { return __crc32cb(crc, byte); }
+bool HasHardware() { return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0; }
+
+#endif
+
+#ifdef BUSTUB_CRC32C_TARGET
+
+BUSTUB_CRC32C_TARGET uint32_t HardwareUpdate(uint32_t crc, const char *data, size_t size) {
+  const Tables &tables = GetTables();
+  // Three independent dependency chains keep the CRC unit busy. The registers of the streams are combined as if they
+  // had been computed one after the other: going on from a register over a stream is the same as shifting the
+  // register over as many zero bytes and adding the register of the stream on its own.
+  while (size >= 3 * STREAM_SIZE) {
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    for (size_t i = 0; i < STREAM_SIZE; i += 8) {
+      crc = Step64(crc, Load64(data + i));
+      crc1 = Step64(crc1, Load64(data + STREAM_SIZE + i));
+      crc2 = Step64(crc2, Load64(data + 2 * STREAM_SIZE + i));
+    }
+    crc = tables.Shift(tables.Shift(crc) ^ crc1) ^ crc2;
+    data += 3 * STREAM_SIZE;
+    size -= 3 * STREAM_SIZE;
+  }
+  for (; size >= 8; size -= 8) {
+    crc = Step64(crc, Load64(data));
+    data += 8;
+  }
+  for (; size > 0; size--) {
+    crc = Step8(crc, static_cast<uint8_t>(*data++));
+  }
+  return crc;
+}
+
+#endif
+
+using UpdateFunction = uint32_t (*)(uint32_t, const char *, size_t);
+
+UpdateFunction GetUpdate() {
+  static const UpdateFunction update = []() -> UpdateFunction {
+#ifdef BUSTUB_CRC32C_TARGET
+    if (HasHardware()) {
+      return HardwareUpdate;
+    }
+#endif
+    return TableUpdate;
+  }();
+  return update;
+}
+
+}  // namespace
+
+uint32_t Crc32c::Compute(const char *data, size_t size, uint32_t crc) { return ~GetUpdate()(~crc, data, size); }
+
+uint32_t Crc32c::ComputeWithTable(const char *data, size_t size, uint32_t crc) {
+  return ~TableUpdate(~crc, data, size);
+}
+
+bool Crc32c::IsHardware() { return GetUpdate() != TableUpdate; }
+
+}  // namespace bustub
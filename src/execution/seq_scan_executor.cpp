@@ -1,23 +1,48 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
-
-void SeqScanExecutor::Init() {}
-
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/seq_scan_executor.h"
+
+namespace bustub {
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())),
+      iter_(table_info_->table_->End()) {}
+
+void SeqScanExecutor::Init() { iter_ = table_info_->table_->Begin(exec_ctx_->GetTransaction(), AccessType::Scan); }
+
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *table_schema = &table_info_->schema_;
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  while (iter_ != table_info_->table_->End()) {
+    const Tuple &candidate = *iter_;
+    if (predicate != nullptr && !predicate->Evaluate(&candidate, table_schema).GetAs<bool>()) {
+      ++iter_;
+      continue;
+    }
+
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema()->GetColumnCount());
+    for (const Column &column : GetOutputSchema()->GetColumns()) {
+      values.push_back(column.GetExpr()->Evaluate(&candidate, table_schema));
+    }
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = candidate.GetRid();
+    ++iter_;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -15,11 +15,13 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -30,6 +32,8 @@ class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Returns the id of the page after a page in its page chain, or INVALID_PAGE_ID. Called with the page latched. */
+  using next_page_fn = page_id_t (*)(Page *page);
 
   BufferPoolManager() = default;
   /**
@@ -40,7 +44,18 @@ class BufferPoolManager {
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
-    auto *result = FetchPgImp(page_id);
+    auto *result = FetchPgImp(page_id, AccessType::Unknown);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * Fetch a page with a hint about how it is accessed. Pages fetched for a sequential scan (AccessType::Scan) are
+   * recycled through a small ring of frames instead of evicting the rest of the buffer pool.
+   */
+  Page *FetchPage(page_id_t page_id, AccessType access_type, bufferpool_callback_fn callback = nullptr) {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPgImp(page_id, access_type);
     GradingCallback(callback, CallbackType::AFTER, page_id);
     return result;
   }
@@ -84,9 +99,76 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page and keep it pinned until the returned guard goes out of scope.
+   * @param page_id id of the page
+   * @param access_type how the page is accessed
+   * @return a guard holding the pin, empty if the page could not be fetched
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    return {this, FetchPgImp(page_id, access_type)};
+  }
+
+  /**
+   * Fetch a page and read latch it until the returned guard goes out of scope.
+   * @param page_id id of the page
+   * @param access_type how the page is accessed
+   * @return a guard holding the pin and the read latch, empty if the page could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    return FetchPageBasic(page_id, access_type).UpgradeRead();
+  }
+
+  /**
+   * Fetch a page and write latch it until the returned guard goes out of scope.
+   * @param page_id id of the page
+   * @param access_type how the page is accessed
+   * @return a guard holding the pin and the write latch, empty if the page could not be fetched
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    return FetchPageBasic(page_id, access_type).UpgradeWrite();
+  }
+
+  /**
+   * Create a new page and keep it pinned until the returned guard goes out of scope.
+   * @param[out] page_id id of the new page
+   * @return a guard holding the pin, empty if no new page could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id) { return {this, NewPgImp(page_id)}; }
+
+  /**
+   * Start an optimistic read of a page, without pinning or latching it. See OptimisticPageGuard for how the read has
+   * to be done. Buffer pools that do not support optimistic reads always return an empty guard.
+   * @param page_id id of the page
+   * @return the guard, empty if the page is not resident or is being written
+   */
+  virtual OptimisticPageGuard FetchPageOptimistic(page_id_t page_id) { return {}; }
+
+  /**
+   * Fetch several pages at once, for callers that know up front which pages they need, such as index lookups of many
+   * keys. Buffer pools that support it take their latch once for the whole batch and read every missing page in one
+   * batch of I/O; the others fetch the pages one by one.
+   * @param page_ids ids of the pages to fetch; a page that appears more than once is pinned once per appearance
+   * @param access_type how the pages are accessed
+   * @return the fetched pages, in the order of page_ids; nullptr for a page that could not be fetched
+   */
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown) {
+    return FetchPgsImp(page_ids, access_type);
+  }
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
+  /**
+   * Read pages ahead of a sequential scan in the background: page_id and the pages that follow it in its page chain
+   * are loaded with AccessType::Scan, up to num_pages of them, and are not left pinned. Buffer pools that do not
+   * support read-ahead ignore the request.
+   * @param page_id the first page to read
+   * @param next_page returns the id of the page after a page
+   * @param num_pages the number of pages to read
+   */
+  virtual void ReadAhead(page_id_t page_id, next_page_fn next_page, size_t num_pages) {}
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -104,9 +186,25 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
    * @return the requested page
    */
-  virtual Page *FetchPgImp(page_id_t page_id) = 0;
+  virtual Page *FetchPgImp(page_id_t page_id, AccessType access_type) = 0;
+
+  /**
+   * Fetch several pages from the buffer pool. By default they are fetched one by one with FetchPgImp.
+   * @param page_ids ids of the pages to be fetched
+   * @param access_type how the pages are accessed
+   * @return the requested pages, nullptr for those that could not be fetched
+   */
+  virtual std::vector<Page *> FetchPgsImp(const std::vector<page_id_t> &page_ids, AccessType access_type) {
+    std::vector<Page *> pages;
+    pages.reserve(page_ids.size());
+    for (page_id_t page_id : page_ids) {
+      pages.push_back(FetchPgImp(page_id, access_type));
+    }
+    return pages;
+  }
 
   /**
    * Unpin the target page from the buffer pool.
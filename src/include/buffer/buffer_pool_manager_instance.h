@@ -12,12 +12,26 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/read_ahead_worker.h"
+#include "common/per_core_counters.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -26,6 +40,20 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Fetching a resident page and unpinning a page take no latch: the page table supports lock-free lookups, and pages
+ * are pinned with an atomic compare-and-swap on their pin count. The replacer therefore cannot be told about every
+ * pin and unpin. Instead it holds every resident frame, and a victim it proposes is only taken if it is unpinned and
+ * has not been referenced since the last time it was proposed.
+ *
+ * Pages fetched with AccessType::Scan are loaded into a small ring of frames that is recycled in order, like the
+ * bulk-read strategy of PostgreSQL, so a large sequential scan only ever occupies a few frames of the pool. A ring
+ * frame that somebody else pinned or referenced in the meantime is left to the replacer and replaced in the ring.
+ *
+ * With page checksums switched on, every page written back has its CRC-32C stored by the disk manager once the write
+ * completed, and every page read in is checked against the stored one. A page that does not match, e.g. because a
+ * write of it was torn, is not handed out: the fetch throws an Exception of type CORRUPT_PAGE. A page whose last write
+ * never completed, because the process stopped during it, has no checksum to match and is handed out for redo.
  */
 class BufferPoolManagerInstance : public BufferPoolManager {
   friend class ParallelBufferPoolManager;
@@ -36,8 +64,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -45,9 +75,11 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -60,13 +92,69 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  void ReadAhead(page_id_t page_id, next_page_fn next_page, size_t num_pages) override;
+
+  OptimisticPageGuard FetchPageOptimistic(page_id_t page_id) override;
+
+  /**
+   * Start the background writer thread, which runs a BackgroundWriterRound every bg_writer_delay until
+   * StopBackgroundWriter is called or the instance is destroyed.
+   */
+  void RunBackgroundWriter();
+
+  /**
+   * Stop and join the background writer thread, if it is running.
+   */
+  void StopBackgroundWriter();
+
+  /**
+   * Write back dirty pages that the replacer is likely to pick next, so that eviction finds clean victims. Nothing is
+   * written while at least bg_writer_clean_target of the frames are free or clean and unpinned; otherwise the writer
+   * sweeps the frames from where it stopped last time and writes at most bg_writer_max_pages unpinned dirty pages,
+   * preferring unreferenced ones. The writes of a round are issued as one batch of asynchronous I/O. A page whose LSN
+   * is not yet persistent is skipped, as writing it would break write-ahead logging.
+   * @return the number of pages written
+   */
+  size_t BackgroundWriterRound();
+
+  /** @return what this instance has been doing since it was created */
+  BufferPoolStats GetStats();
+
+  /**
+   * Switch page checksums on or off for this instance; the default is enable_page_checksums. Pages written back while
+   * they are off lose their checksum, so that they are not reported as corrupt once checksums are back on.
+   * @param enabled true to checksum the pages written back and verify the pages read in
+   */
+  void SetPageChecksums(bool enabled) { page_checksums_ = enabled; }
+
+  /** @return true if this instance checksums the pages it writes back and verifies the pages it reads in */
+  bool IsPageChecksums() const { return page_checksums_; }
+
+  /**
+   * @return the number of frames that are not pinned, without taking the latch. Only a hint, as pins come and go
+   * concurrently; 0 means that a new page would most likely not find a frame.
+   */
+  size_t GetNumUnpinnedFrames() const { return pool_size_ - pinned_frames_.load(std::memory_order_relaxed); }
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
    * @return the requested page
    */
-  Page *FetchPgImp(page_id_t page_id) override;
+  Page *FetchPgImp(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Fetch several pages from the buffer pool. Resident pages are pinned without the latch, like in FetchPgImp. Then,
+   * under a single acquisition of the latch, a frame is claimed for every missing page, and with the latch released
+   * again the write-backs of dirty victims and the reads of the missing pages are issued as batches of asynchronous
+   * I/O. Pages that another thread is loading or writing back at the time are fetched one by one afterwards.
+   * @param page_ids ids of the pages to be fetched
+   * @param access_type how the pages are accessed
+   * @return the requested pages, nullptr for those that could not be fetched
+   */
+  std::vector<Page *> FetchPgsImp(const std::vector<page_id_t> &page_ids, AccessType access_type) override;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -98,23 +186,52 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk, in page id order and in batches of asynchronous writes.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Flushes the dirty pages that pass a filter, the same way as FlushAllPgsImp.
+   * @param filter returns true for the ids of pages to flush; nullptr flushes every dirty page
+   */
+  void FlushDirtyPages(const std::function<bool(page_id_t)> &filter);
+
+  /**
+   * Evicts a page from the buffer pool, writing it back first if it is dirty. Unlike DeletePgImp, the page stays
+   * allocated on disk.
+   * @param page_id id of page to be evicted
+   * @return false if the page is pinned, true if it was evicted or was not resident
+   */
+  bool EvictPgImp(page_id_t page_id);
+
+  /** @return the ids of all the pages that occupy a frame */
+  std::vector<page_id_t> GetResidentPageIds();
+
+  /**
+   * Allocate a page on disk: the lowest id in the free page map that this BPI can hand out, or a new one.
+   * @param[out] reused true if the id came from the free page map, so a deleted page may still be on disk under it
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(bool *reused);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, returning its id to the free page map.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @param page_id id of page
+   * @return true if this BPI hands out page_id
+   */
+  bool CanAllocate(page_id_t page_id) const;
+
+  /**
+   * Reset a frame and return it to the free list. Must be called with latch_ held and the frame claimed with
+   * PIN_COUNT_BUSY.
+   * @param frame_id the frame to free
+   */
+  void FreeFrame(frame_id_t frame_id);
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -123,6 +240,195 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
+  /**
+   * Lifecycle of a frame. A frame is only handed out to callers once it is READY; while it is EVICTING (its old
+   * contents are being written back) or LOADING (its new contents are being read in) the disk I/O runs without latch_,
+   * and anybody interested in the frame waits on its condition variable instead.
+   */
+  enum class FrameState { FREE, EVICTING, LOADING, READY };
+
+  /**
+   * Block until the frame is neither EVICTING nor LOADING. latch_ is released while waiting.
+   * @param lock the held lock on latch_
+   * @param frame_id the frame to wait for
+   */
+  void WaitForFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Block until no write-back of the resident page of a frame is in flight. latch_ is released while waiting.
+   * @param lock the held lock on latch_
+   * @param frame_id the frame to wait for
+   */
+  void WaitForWriteBack(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Mark the write-backs of the given frames done and wake their waiters. Takes latch_.
+   * @param frame_ids the frames whose writes completed
+   */
+  void FinishWriteBacks(const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * Lock latch_, recording in the metrics how long it took if it was taken.
+   * @return the held lock
+   */
+  std::unique_lock<std::mutex> LockLatch();
+
+  /**
+   * Pick a frame for a new resident page, from the free list first and the replacer second.
+   * Must be called with latch_ held.
+   * @param[out] frame_id the frame that was picked
+   * @return false if every frame is pinned or busy, true otherwise
+   */
+  bool AcquireFrame(frame_id_t *frame_id);
+
+  /**
+   * Pick a frame for a page fetched by a sequential scan: the next frame of the scan ring if it can be reused, and a
+   * frame from AcquireFrame otherwise, which then takes its place in the ring. Must be called with latch_ held.
+   * @param[out] frame_id the frame that was picked
+   * @return false if every frame is pinned or busy, true otherwise
+   */
+  bool AcquireScanFrame(frame_id_t *frame_id);
+
+  /**
+   * Pin a page without holding latch_. Fails if the frame is being evicted or loaded, or no longer holds page_id.
+   * @param frame_id the frame holding the page
+   * @param page_id the page id the caller expects the frame to hold
+   * @param access_type how the page is accessed; scans do not set the reference bit
+   * @return true if the page was pinned, false otherwise
+   */
+  bool TryPin(frame_id_t frame_id, page_id_t page_id, AccessType access_type);
+
+  /** A frame claimed for a page by BeginInstall, whose I/O still has to run before FinishInstall. */
+  struct PendingInstall {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    /** The dirty page that has to be written back out of the frame first, INVALID_PAGE_ID if there is none. */
+    page_id_t write_back_page_id_;
+  };
+
+  /** A batched fetch between StartFetchPages and FinishFetchPages, with the I/O of its first batch in flight. */
+  struct PendingFetch {
+    std::vector<page_id_t> page_ids_;
+    AccessType access_type_;
+    /** The pages fetched so far, in the order of page_ids_. */
+    std::vector<Page *> pages_;
+    /** The frames claimed for missing pages, with the positions of the pages in page_ids_. */
+    std::vector<std::pair<size_t, PendingInstall>> installs_;
+    /** Positions of the pages that were being loaded or written back, fetched one by one at the end. */
+    std::vector<size_t> deferred_;
+    std::vector<std::future<bool>> writes_;
+    std::vector<std::future<bool>> reads_;
+  };
+
+  /**
+   * First half of FetchPgsImp: pin the resident pages, claim frames for the missing ones and submit their I/O
+   * without waiting for it. A parallel BPM starts the fetches of all its instances before finishing any of them.
+   * @param page_ids ids of the pages to fetch
+   * @param access_type how the pages are accessed
+   * @return the fetch, to be passed to FinishFetchPages
+   */
+  PendingFetch StartFetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type);
+
+  /**
+   * Second half of FetchPgsImp: wait for the I/O of a fetch and install its pages. Must be called for every fetch that
+   * was started, as its frames stay claimed until then.
+   * @param fetch the fetch returned by StartFetchPages
+   * @return the fetched pages, in the order of page_ids; nullptr for a page that could not be fetched
+   * @throws Exception of type CORRUPT_PAGE if a page failed verification, with none of the pages left pinned
+   */
+  std::vector<Page *> FinishFetchPages(PendingFetch *fetch);
+
+  /**
+   * First half of InstallPage, run with latch_ held: evict the frame's old page, reserve the page table entry for
+   * page_id and put the frame into the EVICTING or LOADING state.
+   * @param frame_id the frame returned by AcquireFrame
+   * @param page_id the page to install
+   * @return the install, to be passed to FinishInstall once its I/O is done
+   */
+  PendingInstall BeginInstall(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Second half of InstallPage, run with latch_ held: make the frame READY, pinned once, and wake its waiters.
+   * @param install the install returned by BeginInstall
+   * @param access_type how the page is accessed
+   */
+  void FinishInstall(const PendingInstall &install, AccessType access_type);
+
+  /**
+   * Undo BeginInstall after the page read into the frame failed verification, run with latch_ held: drop the page
+   * table entry and return the frame to the free list.
+   * @param install the install returned by BeginInstall
+   */
+  void AbortInstall(const PendingInstall &install);
+
+  /**
+   * Mark the checksum of a page that is about to be written back pending, or remove it if checksums are off.
+   * @param page_id id of the page
+   */
+  void BeginChecksumWrite(page_id_t page_id);
+
+  /**
+   * Store the checksum of a page once its write-back completed, if checksums are on.
+   * @param page_id id of the page
+   * @param data the page data that was written
+   */
+  void StoreChecksum(page_id_t page_id, const char *data);
+
+  /**
+   * Check a page that was read in against its stored checksum, if checksums are on and it has one.
+   * @param page_id id of the page
+   * @param data the page data that was read
+   * @return false if the page does not match its checksum
+   */
+  bool VerifyChecksum(page_id_t page_id, const char *data);
+
+  /**
+   * Report a page that failed verification.
+   * @param page_id id of the page
+   * @throws Exception of type CORRUPT_PAGE, always
+   */
+  [[noreturn]] static void ThrowCorruptPage(page_id_t page_id);
+
+  /**
+   * Install page_id into frame_id and return it pinned once. The page table entry is reserved under latch_, then the
+   * write-back of a dirty previous occupant and the read of page_id (or zeroing, for new pages) run with latch_
+   * released, so that they only stall threads interested in this particular frame.
+   * @param lock the held lock on latch_, held again when this function returns
+   * @param frame_id the frame returned by AcquireFrame
+   * @param page_id the page to install
+   * @param read_from_disk true to read the page contents from disk, false to zero them
+   * @param access_type how the page is accessed
+   * @return the installed page
+   * @throws Exception of type CORRUPT_PAGE if the page was read from disk and failed verification
+   */
+  Page *InstallPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id, page_id_t page_id, bool read_from_disk,
+                    AccessType access_type);
+
+  /**
+   * Get the page in frame_id ready for the background writer, if it is dirty and unpinned: pin it, copy its contents
+   * and mark it clean. The caller writes the copy out and then drops the pin.
+   * @param frame_id the frame to look at
+   * @param write_referenced false to skip the page if its reference bit is set
+   * @param[out] buffer receives a copy of the page
+   * @return true if the page was pinned and copied
+   */
+  bool PrepareBackgroundWrite(frame_id_t frame_id, bool write_referenced, char *buffer);
+
+  /**
+   * Add a pin to a READY page, counting its frame as pinned if it was not.
+   * @param page the page
+   */
+  void AddPin(Page *page);
+
+  /**
+   * Drop a pin from a page, counting its frame as unpinned if it was the last one.
+   * @param page the page
+   */
+  void DropPin(Page *page);
+
+  /** Pin count of a frame that is claimed for eviction, loading or deletion, which makes TryPin fail. */
+  static constexpr int PIN_COUNT_BUSY = -1;
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
@@ -131,22 +437,82 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   const uint32_t instance_index_ = 0;
   /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
   std::atomic<page_id_t> next_page_id_ = instance_index_;
+  /**
+   * Set by a parallel BPM that routes page ids through its own table. Page ids are then allocated in increasing
+   * order, skipping those this BPI does not own, instead of with a stride of num_instances_.
+   */
+  std::function<bool(page_id_t)> owns_page_;
+  /** The page ids this BPI deallocated, and where next_page_id_ continues after a restart. */
+  std::unique_ptr<FreePageMap> free_page_map_;
+  /** Serializes page allocation and deallocation, which may write to the free page map. Never held with latch_. */
+  std::mutex allocation_latch_;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** The data of the buffer pool pages; pages_[i] holds frame i. */
+  FrameArena frame_arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
+  /** Page table for keeping track of buffer pool pages. Modified under latch_, read without it. */
+  PageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. Holds every resident frame, pinned or not. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects.
-   * used when data member is changed.
-   * */
+  /** State of every frame, indexed by frame id. */
+  std::vector<FrameState> frame_states_;
+  /** Signalled whenever the corresponding frame leaves the EVICTING or LOADING state, or its write-back completes. */
+  std::vector<std::condition_variable> frame_cvs_;
+  /**
+   * True while the resident page of the frame is written back by FlushPage, FlushAllPages or the background writer.
+   * At most one such write of a frame is in flight, so that an older image can never land after a newer one.
+   */
+  std::vector<bool> frame_writing_;
+  /** Pages whose dirty contents are still being written back, mapped to the frame that is writing them. */
+  std::unordered_map<page_id_t, frame_id_t> evicting_pages_;
+  /** Frames recycled by sequential scans, at most scan_ring_capacity_ of them. */
+  std::vector<frame_id_t> scan_ring_;
+  /** The ring frame to recycle next. */
+  size_t scan_ring_next_ = 0;
+  /** Size of the scan ring, SCAN_RING_SIZE capped to a quarter of the pool. */
+  const size_t scan_ring_capacity_;
+  /** The frame the background writer looks at next. Only used by the writer. */
+  size_t bg_writer_hand_ = 0;
+  /**
+   * Where the background writer copies the pages it writes, page-aligned like the frames themselves so that O_DIRECT
+   * writes need no extra copy. Mapped by the first round with work to do, and again only if bg_writer_max_pages
+   * grows. Only used by the writer.
+   */
+  std::unique_ptr<FrameArena> bg_writer_buffers_;
+  size_t bg_writer_buffers_size_ = 0;
+  /**
+   * Serializes changes to the page table, the free list, the replacer, the frame states, the write-backs in flight,
+   * the evicting pages and the scan ring, and claims of frames for eviction. It is never held across disk I/O, and not
+   * taken on hits and unpins.
+   */
   std::mutex latch_;
+  /**
+   * Number of frames with a pin count above 0, for GetNumUnpinnedFrames. Kept up to date lock-free at every 0 to 1 and
+   * 1 to 0 change of a pin count; frames claimed with PIN_COUNT_BUSY count as unpinned.
+   */
+  std::atomic<size_t> pinned_frames_{0};
+  /** True if page checksums are on, see SetPageChecksums. */
+  std::atomic<bool> page_checksums_{enable_page_checksums.load()};
+  /** Event counters for GetStats, bumped on per-core cache lines so that hits do not contend on them. */
+  PerCoreCounters<BPM_NUM_COUNTERS> metrics_;
+
+  /** The background writer thread, nullptr unless it is running. */
+  std::thread *bg_writer_thread_ = nullptr;
+  /** True while the background writer should keep running. Guarded by bg_writer_latch_. */
+  bool bg_writer_running_ = false;
+  /** Protects bg_writer_running_; starting and stopping the writer take it too. */
+  std::mutex bg_writer_latch_;
+  /** Wakes the background writer up early when it is stopped. */
+  std::condition_variable bg_writer_cv_;
+
+  /** Loads pages ahead of sequential scans. */
+  ReadAheadWorker read_ahead_worker_;
 };
 }  // namespace bustub
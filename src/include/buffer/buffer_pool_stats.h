@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/** The event counters a buffer pool instance keeps, as indexes into its PerCoreCounters. */
+enum BufferPoolCounter : size_t {
+  BPM_HITS,
+  BPM_MISSES,
+  BPM_EVICTIONS,
+  BPM_DIRTY_WRITE_BACKS,
+  BPM_FLUSHED_PAGES,
+  BPM_PIN_WAITS,
+  BPM_LATCH_WAITS,
+  BPM_LATCH_WAIT_NS,
+  BPM_REPLACER_SKIPS,
+  BPM_CHECKSUMS_WRITTEN,
+  BPM_CHECKSUMS_VERIFIED,
+  BPM_CHECKSUM_FAILURES,
+  BPM_CHECKSUMS_PENDING,
+  BPM_NUM_COUNTERS
+};
+
+/**
+ * A snapshot of what a buffer pool has been doing, for sizing pools and choosing a replacer. The counters add up
+ * since the pool was created; the frame counts are taken at the time of the snapshot.
+ */
+struct BufferPoolStats {
+  /** Fetches of pages that were resident. */
+  uint64_t hits_ = 0;
+  /** Fetches of pages that were not resident, whether or not they got a frame. */
+  uint64_t misses_ = 0;
+  /** Pages that lost their frame to another page. */
+  uint64_t evictions_ = 0;
+  /** Evicted pages that were dirty and written back first. */
+  uint64_t dirty_write_backs_ = 0;
+  /** Pages written by FlushPage, FlushAllPages and the background writer. */
+  uint64_t flushed_pages_ = 0;
+  /** Times a thread waited for a page that was being read in or written back. */
+  uint64_t pin_waits_ = 0;
+  /** Times a thread found the buffer pool latch taken, and how long it waited for it in total. */
+  uint64_t latch_waits_ = 0;
+  uint64_t latch_wait_ns_ = 0;
+  /** Frames the replacer picked that were passed over because they were referenced or pinned. */
+  uint64_t replacer_skips_ = 0;
+  /** Pages written back with a checksum, pages read in that were checked against theirs, and those that failed. */
+  uint64_t checksums_written_ = 0;
+  uint64_t checksums_verified_ = 0;
+  uint64_t checksum_failures_ = 0;
+  /** Pages read in whose last write with a checksum never completed, so that they need redo from the log. */
+  uint64_t checksums_pending_ = 0;
+  /** Frames in the pool, free frames, and frames the replacer could evict right now. */
+  size_t pool_size_ = 0;
+  size_t free_frames_ = 0;
+  size_t evictable_frames_ = 0;
+
+  /** @return the share of fetches that were hits, 0 if there were none */
+  double HitRatio() const {
+    const uint64_t fetches = hits_ + misses_;
+    return fetches == 0 ? 0.0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+  }
+
+  /** Add the stats of another pool, for the stats of a parallel buffer pool. */
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    dirty_write_backs_ += other.dirty_write_backs_;
+    flushed_pages_ += other.flushed_pages_;
+    pin_waits_ += other.pin_waits_;
+    latch_waits_ += other.latch_waits_;
+    latch_wait_ns_ += other.latch_wait_ns_;
+    replacer_skips_ += other.replacer_skips_;
+    checksums_written_ += other.checksums_written_;
+    checksums_verified_ += other.checksums_verified_;
+    checksum_failures_ += other.checksum_failures_;
+    checksums_pending_ += other.checksums_pending_;
+    pool_size_ += other.pool_size_;
+    free_frames_ += other.free_frames_;
+    evictable_frames_ += other.evictable_frames_;
+    return *this;
+  }
+};
+
+}  // namespace bustub
@@ -12,9 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
@@ -23,6 +22,11 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has an atomic reference bit and an atomic evictable bit in fixed arrays indexed by frame id, so Pin,
+ * Unpin and Victim take no latch and never allocate. Victim advances a shared clock hand over the frames, clearing
+ * reference bits, until it claims an evictable frame whose reference bit is already clear. A frame accessed by a scan
+ * loses its reference bit, so the hand takes it on its next pass.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +47,21 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Number of frames, i.e. the length of the arrays below. */
+  const size_t num_pages_;
+  /** True if the frame is in the replacer, i.e. it may be victimized. */
+  std::unique_ptr<std::atomic<bool>[]> evictable_;
+  /** True if the frame was unpinned since the clock hand last passed over it. */
+  std::unique_ptr<std::atomic<bool>[]> ref_;
+  /** Position of the clock hand; taken modulo num_pages_. */
+  std::atomic<size_t> hand_{0};
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the page data of all the frames of a buffer pool instance in one block of memory, apart from the
+ * frame descriptors (Page). Every frame starts on a PAGE_SIZE boundary, as O_DIRECT I/O requires. A pool of at least
+ * one huge page is backed by 2 MB huge pages where the system has them, so that it takes far fewer TLB entries.
+ */
+class FrameArena {
+ public:
+  /** How the memory of an arena is backed. */
+  enum class Backing { PAGES, TRANSPARENT_HUGE_PAGES, HUGETLB };
+
+  /**
+   * Map zeroed memory for num_frames frames.
+   * @param num_frames the number of frames
+   * @throws Exception if the memory cannot be mapped
+   */
+  explicit FrameArena(size_t num_frames);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of the given frame, PAGE_SIZE bytes */
+  char *GetFrame(frame_id_t frame_id) const { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * @return HUGETLB if the arena is made of reserved huge pages, TRANSPARENT_HUGE_PAGES if it is aligned to huge
+   * pages and the kernel was asked to back it with them, and PAGES otherwise
+   */
+  Backing GetBacking() const { return backing_; }
+
+ private:
+  char *data_ = nullptr;
+  /** Size of the mapping starting at data_. */
+  size_t mapped_size_ = 0;
+  Backing backing_ = Backing::PAGES;
+};
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose K-th most recent access lies furthest in the past (its backward
+ * K-distance is the largest). Frames with fewer than K recorded accesses have an infinite backward K-distance and are
+ * evicted first, oldest first access first. A page touched once by a sequential scan therefore goes before a page
+ * that an index keeps coming back to, no matter how recent the scan was. Accesses hinted as AccessType::Scan are not
+ * recorded at all.
+ *
+ * Access history lives in fixed per-frame arrays and is recorded with atomics only, so RecordAccess, Pin and Unpin
+ * take no latch. Victim scans all frames under its own latch.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of most recent accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  /** Takes the frame out of the replacer and forgets its access history, which belonged to the evicted page. */
+  void Remove(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+
+  size_t Size() override;
+
+ private:
+  /** @return the timestamp of the oldest access remembered for the frame, 0 if it has none */
+  uint64_t OldestAccess(size_t frame_id, size_t access_count) const;
+
+  const size_t num_pages_;
+  const size_t k_;
+  /** True if the frame is in the replacer, i.e. it may be victimized. */
+  std::unique_ptr<std::atomic<bool>[]> evictable_;
+  /** Number of accesses recorded per frame since its last page was removed. */
+  std::unique_ptr<std::atomic<size_t>[]> access_count_;
+  /** The last k access timestamps of every frame, in a ring per frame indexed by access count modulo k. */
+  std::unique_ptr<std::atomic<uint64_t>[]> history_;
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_{0};
+  /** Serializes victim selection. */
+  std::mutex victim_latch_;
+};
+
+}  // namespace bustub
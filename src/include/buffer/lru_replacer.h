@@ -44,6 +44,9 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  // a frame accessed by a scan is moved to the LRU end, so that it is the next victim
+  void RecordAccess(frame_id_t frame_id, AccessType access_type) override;
+
   size_t Size() override;
 
  private:
@@ -92,6 +95,13 @@ class LRUReplacer : public Replacer {
     head_->next_->prev_ = Node2Insert;
     head_->next_ = Node2Insert;
   }
+
+  void InsertAtTail(FrameListNode *Node2Insert) {
+    Node2Insert->next_ = tail_;
+    Node2Insert->prev_ = tail_->prev_;
+    tail_->prev_->next_ = Node2Insert;
+    tail_->prev_ = Node2Insert;
+  }
 };
 
 }  // namespace bustub
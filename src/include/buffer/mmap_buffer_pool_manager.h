@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager serves a database file that is only read, such as the snapshot of an analytics replica, out
+ * of a read-only memory mapping of the file. A fetched page is a view into the mapping: there are no frames to load it
+ * into, no page table and no eviction, and the kernel page cache decides which pages stay in memory. Opening a large
+ * file is therefore instant, and a page costs nothing until it is first fetched.
+ *
+ * The interface is that of every buffer pool, so executors work unchanged, but nothing can be written: NewPage and
+ * DeletePage fail, UnpinPage with is_dirty set is refused, and writing to the data of a page crashes the process.
+ * Pages keep their latches and pin counts, which only serve callers that expect them. The file must not grow or
+ * shrink while it is mapped, and the pages must not be used after the disk manager is shut down.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new MmapBufferPoolManager over the whole database file as it is now.
+   * @param disk_manager the disk manager
+   * @throws Exception if the database file cannot be mapped
+   */
+  explicit MmapBufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * Destroys the page views. The mapping belongs to the disk manager.
+   */
+  ~MmapBufferPoolManager() override;
+
+  /** @return the number of pages in the mapped database file */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /** Pages are never written, so an optimistic read of a mapped page always validates. */
+  OptimisticPageGuard FetchPageOptimistic(page_id_t page_id) override;
+
+ protected:
+  /**
+   * Fetch the requested page from the mapping.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed; ignored
+   * @return the requested page, nullptr if it is not in the file
+   */
+  Page *FetchPgImp(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Unpin the target page.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty must be false, as the page cannot be written back
+   * @return false if the page pin count is <= 0 before this call, or if is_dirty is set, in which case the page stays
+   * pinned; true otherwise
+   */
+  bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Nothing is ever dirty, so there is nothing to flush.
+   * @param page_id id of page to be flushed
+   * @return false
+   */
+  bool FlushPgImp(page_id_t page_id) override { return false; }
+
+  /**
+   * New pages cannot be created in a read-only file.
+   * @param[out] page_id id of created page
+   * @return nullptr
+   */
+  Page *NewPgImp(page_id_t *page_id) override { return nullptr; }
+
+  /**
+   * Pages cannot be deleted from a read-only file.
+   * @param page_id id of page to be deleted
+   * @return false
+   */
+  bool DeletePgImp(page_id_t page_id) override { return false; }
+
+  /**
+   * Nothing is ever dirty, so there is nothing to flush.
+   */
+  void FlushAllPgsImp() override {}
+
+ private:
+  /**
+   * @param page_id id of a page in the file
+   * @return the view of the page, created on first use
+   */
+  Page *GetPageView(page_id_t page_id);
+
+  /** The mapped database file. */
+  char *mapping_;
+  /** Number of whole pages in the mapping. */
+  size_t num_pages_;
+  /** The view of every page that was fetched, nullptr for the others. Filled in lock-free. */
+  std::unique_ptr<std::atomic<Page *>[]> page_views_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids resident in a buffer pool instance to the frames holding them. It is an open-addressing
+ * hash table with linear probing whose slots are single atomic words, so that lookups never take a latch.
+ *
+ * Inserts and removals must be serialized by the caller. A lookup that runs concurrently with a removal may miss an
+ * entry that is being shifted into the hole, or return a mapping that was just removed; lock-free readers must
+ * therefore validate the frame they get back and repeat a miss under the writers' latch. Lookups made while holding
+ * that latch are exact.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries the table will be required to store
+   */
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Look up the frame holding a page. Safe to call without any latch.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page was found, false otherwise
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Map a page to a frame, replacing any existing mapping of the page. Writers must be serialized.
+   * @param page_id the page to insert, must not be INVALID_PAGE_ID
+   * @param frame_id the frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the mapping of a page. Writers must be serialized.
+   * @param page_id the page to remove
+   * @return true if the page was found and removed, false otherwise
+   */
+  bool Remove(page_id_t page_id);
+
+  /** @return the number of pages in the table */
+  size_t Size() const { return size_; }
+
+ private:
+  /** A slot holds the page id in its upper and the frame id in its lower 32 bits; all ones marks an empty slot. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static uint64_t MakeSlot(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t SlotPageId(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t SlotFrameId(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot at which probing for page_id starts */
+  size_t HomeSlot(page_id_t page_id) const;
+
+  /** Number of slots, a power of two at least twice the number of frames. */
+  size_t capacity_;
+  /** Right shift that turns a 64-bit hash into a slot index. */
+  uint32_t hash_shift_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Number of entries, only modified by writers. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
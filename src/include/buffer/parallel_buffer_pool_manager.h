@@ -12,20 +12,58 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/read_ahead_worker.h"
+#include "common/bustub_config.h"
+#include "common/rwlatch.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * ParallelBufferPoolManager spreads pages over several BufferPoolManagerInstances. A page id is routed to its
+ * instance through an indirection table of BPM_ROUTING_SLOTS slots, so that instances can be added and retired while
+ * the pool is in use: a resize only has to move slots, and the pages in them, from one instance to another.
+ */
 class ParallelBufferPoolManager : public BufferPoolManager {
  private:
   std::vector<BufferPoolManagerInstance *> bpmi_;
-  uint32_t starting_index_ = 0;
+  /**
+   * Instances retired by a resize, at most one per index. They are not deleted before the pool, as optimistic readers
+   * may still be looking at their frames, but a resize that grows the pool again brings them back.
+   */
+  std::vector<BufferPoolManagerInstance *> retired_bpmi_;
+  /** Unique among all the pools ever created, so that threads can tell their allocation cursors of pools apart. */
+  const uint64_t pool_id_;
+  /**
+   * Where NewPgImp starts probing the instances once a thread's own cursor led to a full instance. New threads also
+   * start their cursors from here, so that they go round robin over the instances out of step with each other.
+   */
+  std::atomic<uint32_t> starting_index_{0};
+  /** Page p belongs to bpmi_[routes_[p % BPM_ROUTING_SLOTS]]. */
+  std::vector<uint32_t> routes_;
+  /** Held shared by every operation that uses bpmi_ or routes_, and exclusively while a resize changes them. */
+  PerCoreReaderWriterLatch resize_latch_;
+  /** Serializes resizes, starting and stopping the background writers, and switching page checksums. */
+  std::mutex resize_mutex_;
+  /** Number of frames of each instance. */
+  const size_t pool_size_;
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  const ReplacerType replacer_type_;
+  /** True if the instances run their background writers, which new instances then do as well. */
+  bool bg_writer_running_ = false;
+  /** True if the instances checksum pages, which new instances then do as well. */
+  bool page_checksums_ = enable_page_checksums;
+  /** Loads pages ahead of sequential scans; the page chain of a table crosses instances, so it fetches through here. */
+  ReadAheadWorker read_ahead_worker_{this};
 
  public:
   /**
@@ -34,9 +72,18 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Creates a new ParallelBufferPoolManager sized by a runtime configuration.
+   * @param config the number of instances, their pool size and their replacement policy
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   */
+  ParallelBufferPoolManager(const BustubConfig &config, DiskManager *disk_manager, LogManager *log_manager = nullptr);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -46,6 +93,41 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  void ReadAhead(page_id_t page_id, next_page_fn next_page, size_t num_pages) override;
+
+  OptimisticPageGuard FetchPageOptimistic(page_id_t page_id) override;
+
+  /** Start the background writer of every BufferPoolManagerInstance. */
+  void RunBackgroundWriter();
+
+  /** Stop the background writer of every BufferPoolManagerInstance. */
+  void StopBackgroundWriter();
+
+  /**
+   * Switch page checksums on or off for every BufferPoolManagerInstance, including those added by later resizes.
+   * @param enabled true to checksum the pages written back and verify the pages read in
+   */
+  void SetPageChecksums(bool enabled);
+
+  /** @return the number of BufferPoolManagerInstances */
+  size_t GetNumInstances();
+
+  /** @return the stats of every BufferPoolManagerInstance added up */
+  BufferPoolStats GetStats();
+
+  /** @return the stats of each BufferPoolManagerInstance, to spot instances that are hotter than the others */
+  std::vector<BufferPoolStats> GetInstanceStats();
+
+  /**
+   * Grow or shrink the buffer pool to num_instances instances while it is in use. The routing slots are spread evenly
+   * over the instances again; the pages resident in a slot that changes hands are written back and evicted from
+   * their old instance, and read into the new one on their next fetch. A slot with a pinned page stays where it is,
+   * and an instance that still owns slots is not retired.
+   * @param num_instances the number of instances, between 1 and BPM_ROUTING_SLOTS
+   * @return true if every slot was moved as planned, false if the resize should be retried once pages are unpinned
+   */
+  bool Resize(size_t num_instances);
+
  protected:
   /**
    * @param page_id id of page
@@ -53,12 +135,43 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
 
+  /**
+   * @param page_id id of page
+   * @return index of the instance that owns the page id. Must be called with resize_latch_ held.
+   */
+  uint32_t Route(page_id_t page_id) const { return routes_[static_cast<uint32_t>(page_id) % BPM_ROUTING_SLOTS]; }
+
+  /**
+   * Create the instance with the given index, allocating the page ids routed to it, or bring back the one that was
+   * retired with that index.
+   * @param instance_index index of the instance in bpmi_
+   * @return the instance
+   */
+  BufferPoolManagerInstance *CreateInstance(uint32_t instance_index);
+
+  /**
+   * Make every instance continue allocating after the highest page id any of them handed out, which is needed
+   * whenever the page ids an instance owns may have been handed out by another one: after a restart or a resize.
+   * Must be called with resize_latch_ held for writing, or before the pool is in use.
+   */
+  void SyncNextPageIds();
+
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is accessed
    * @return the requested page
    */
-  Page *FetchPgImp(page_id_t page_id) override;
+  Page *FetchPgImp(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Fetch several pages from the buffer pool. The pages are grouped by the instance they belong to, and every group is
+   * fetched with a single FetchPgsImp of its instance, the groups of different instances concurrently.
+   * @param page_ids ids of the pages to be fetched
+   * @param access_type how the pages are accessed
+   * @return the requested pages, nullptr for those that could not be fetched
+   */
+  std::vector<Page *> FetchPgsImp(const std::vector<page_id_t> &page_ids, AccessType access_type) override;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -90,7 +203,7 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk. The instances flush concurrently.
    */
   void FlushAllPgsImp() override;
 };
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_worker.h
+//
+// Identification: src/include/buffer/read_ahead_worker.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ReadAheadWorker loads pages into a buffer pool on a background thread, so that a sequential scan finds the pages
+ * ahead of it already resident. Pages are loaded with AccessType::Scan, which puts them in the scan ring, and are
+ * unpinned right away.
+ *
+ * The thread is only started by the first request. Requests beyond MAX_PENDING_REQUESTS replace the oldest pending
+ * one, since read-ahead is only a hint and a scan that has moved on does not need its old window any more.
+ */
+class ReadAheadWorker {
+ public:
+  /**
+   * Create a new ReadAheadWorker.
+   * @param bpm the buffer pool to load pages into
+   */
+  explicit ReadAheadWorker(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /**
+   * Destroys the ReadAheadWorker, dropping pending requests.
+   */
+  ~ReadAheadWorker() { Stop(); }
+
+  DISALLOW_COPY_AND_MOVE(ReadAheadWorker);
+
+  /**
+   * Queue a request to load page_id and the num_pages - 1 pages that follow it in its page chain.
+   * @param page_id the first page to load
+   * @param next_page returns the id of the page after a loaded page, INVALID_PAGE_ID at the end of the chain
+   * @param num_pages the number of pages to load
+   */
+  void Schedule(page_id_t page_id, BufferPoolManager::next_page_fn next_page, size_t num_pages);
+
+  /**
+   * Stop and join the thread. Pending requests are dropped, and later requests are ignored.
+   */
+  void Stop();
+
+ private:
+  struct Request {
+    page_id_t page_id_;
+    BufferPoolManager::next_page_fn next_page_;
+    size_t num_pages_;
+  };
+
+  /** Body of the worker thread. */
+  void Run();
+
+  /** Load the pages of one request. */
+  void Load(const Request &request);
+
+  /** Upper bound on the number of queued requests. */
+  static constexpr size_t MAX_PENDING_REQUESTS = 16;
+
+  BufferPoolManager *bpm_;
+  /** The worker thread, nullptr until the first request. */
+  std::thread *thread_ = nullptr;
+  /** Set by Stop; the thread exits and no new one is started. */
+  bool stopped_ = false;
+  std::deque<Request> requests_;
+  /** Protects thread_, stopped_ and requests_. */
+  std::mutex latch_;
+  /** Signalled when a request is queued or the worker is stopped. */
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
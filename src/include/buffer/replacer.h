@@ -16,6 +16,15 @@
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be constructed with. */
+enum class ReplacerType { LRU, CLOCK, LRU_K };
+
+/**
+ * How a page is being accessed, passed down from callers of the buffer pool as a hint. Pages fetched by a sequential
+ * Scan are read once and should not push out pages that other accesses keep coming back to.
+ */
+enum class AccessType { Unknown = 0, Lookup, Scan, Index };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +52,21 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Removes a frame whose page is being evicted. Victim only proposes a frame; the caller may still pass it over and
+   * Unpin it again, so state that belongs to the page in the frame is dropped here rather than in Victim.
+   * @param frame_id the id of the frame that was evicted
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Records that a frame was accessed. Called on every page fetch, possibly concurrently and without any latch held,
+   * so implementations must not block. Policies that only track pins and unpins can ignore it.
+   * @param frame_id the id of the frame that was accessed
+   * @param access_type the access hint given to the buffer pool
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
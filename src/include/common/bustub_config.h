@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bustub_config.h
+//
+// Identification: src/include/common/bustub_config.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BustubConfig holds the sizing of a BusTub instance that is chosen when it starts up rather than at compile time.
+ * The defaults match the compile-time constants in common/config.h.
+ */
+struct BustubConfig {
+  /** Number of frames in each buffer pool instance. */
+  size_t buffer_pool_size_ = BUFFER_POOL_SIZE;
+  /** Number of buffer pool instances. More than one instance gives a ParallelBufferPoolManager. */
+  size_t num_instances_ = 1;
+  /** Replacement policy of every buffer pool instance. */
+  ReplacerType replacer_type_ = ReplacerType::LRU;
+  /** Size of the log buffer (and of the log flush buffer) in bytes. */
+  size_t log_buffer_size_ = LOG_BUFFER_SIZE;
+
+  /**
+   * Read a configuration from the environment, so that each host can be tuned without recompiling. Recognized
+   * variables are BUSTUB_BUFFER_POOL_SIZE, BUSTUB_BUFFER_POOL_INSTANCES, BUSTUB_REPLACER (lru, clock or lru-k) and
+   * BUSTUB_LOG_BUFFER_SIZE; unset variables keep their defaults.
+   * @return the configuration
+   * @throws Exception if a variable has an invalid value
+   */
+  static BustubConfig FromEnvironment();
+
+  /**
+   * Check that the configuration describes a usable instance.
+   * @throws Exception if it does not
+   */
+  void Validate() const;
+};
+
+}  // namespace bustub
@@ -13,6 +13,8 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/bustub_config.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -23,16 +25,30 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * @param db_file_name the database file
+   * @param config the sizing of the buffer pool and the log, e.g. BustubConfig::FromEnvironment()
+   */
+  explicit BustubInstance(const std::string &db_file_name, const BustubConfig &config = BustubConfig()) {
+    config.Validate();
     enable_logging = false;
 
     // storage related
     disk_manager_ = new DiskManager(db_file_name);
 
     // log related
-    log_manager_ = new LogManager(disk_manager_);
+    log_manager_ = new LogManager(disk_manager_, config);
 
-    buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (config.num_instances_ > 1) {
+      auto *buffer_pool_manager = new ParallelBufferPoolManager(config, disk_manager_, log_manager_);
+      buffer_pool_manager->RunBackgroundWriter();
+      buffer_pool_manager_ = buffer_pool_manager;
+    } else {
+      auto *buffer_pool_manager = new BufferPoolManagerInstance(config.buffer_pool_size_, disk_manager_, log_manager_,
+                                                                config.replacer_type_);
+      buffer_pool_manager->RunBackgroundWriter();
+      buffer_pool_manager_ = buffer_pool_manager;
+    }
 
     // txn related
     lock_manager_ = new LockManager();
@@ -47,8 +63,9 @@ class BustubInstance {
       log_manager_->StopFlushThread();
     }
     delete checkpoint_manager_;
-    delete log_manager_;
+    // The buffer pool goes first: its background writer reads the persistent LSN from the log manager.
     delete buffer_pool_manager_;
+    delete log_manager_;
     delete lock_manager_;
     delete transaction_manager_;
     delete disk_manager_;
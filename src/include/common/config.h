@@ -27,14 +27,44 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background writer of each buffer pool instance runs a round every BG_WRITER_DELAY. */
+extern std::chrono::milliseconds bg_writer_delay;
+
+/** The background writer writes at most BG_WRITER_MAX_PAGES dirty pages per round. */
+extern std::atomic<size_t> bg_writer_max_pages;
+
+/** The background writer tries to keep this fraction of the frames of an instance clean and unpinned. */
+extern std::atomic<double> bg_writer_clean_target;
+
+/** True if asynchronous disk I/O should use io_uring when the kernel supports it, false for the thread pool. */
+extern std::atomic<bool> enable_io_uring;
+
+/** True if disk managers should open the database file with O_DIRECT, bypassing the kernel page cache. */
+extern std::atomic<bool> enable_direct_io;
+
+/** True if disk managers should compress the pages of new database files. Existing files keep how they were created. */
+extern std::atomic<bool> enable_page_compression;
+
+/** True if new buffer pools should checksum the pages they write back and verify them when they read them in. */
+extern std::atomic<bool> enable_page_checksums;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
-static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
-static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
+static constexpr int CACHE_LINE_SIZE = 64;                                    // size of a cpu cache line in byte
+static constexpr int BUFFER_POOL_SIZE = 10;                                   // default size of buffer pool
+static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // default size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 32;                                     // frames a seq scan recycles per bpi
+static constexpr int READ_AHEAD_PAGES = 8;                                    // pages a seq scan reads ahead
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;                               // max async disk i/os in flight
+static constexpr int BPM_ROUTING_SLOTS = 1024;                                // page id slots of a parallel bpm
+static constexpr int PAGE_ID_RESERVATION = 1024;                              // page ids a free page map persists ahead
+static constexpr int DB_SEGMENT_PAGES = 262144;                               // pages per db segment file (1 GiB)
+static constexpr int DB_PREALLOCATE_PAGES = 256;                              // pages a segment file is preallocated by
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes CRC-32C (Castagnoli), the checksum of iSCSI, ext4 and most storage engines.
+ *
+ * Where the CPU has them, which is checked once, it uses the crc32 instruction of SSE4.2 on x86-64 and the CRC32
+ * instructions of ARMv8 on aarch64. These have a latency of about three cycles but a throughput of one per cycle, so
+ * long inputs are split into three streams that are checksummed interleaved and combined at the end, which brings a
+ * page down to a few hundred cycles. Other CPUs fall back to a slicing-by-8 table.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the data
+   * @param size size of the data in bytes
+   * @param crc the CRC-32C of the data before this, to checksum data in pieces
+   * @return the CRC-32C of data
+   */
+  static uint32_t Compute(const char *data, size_t size, uint32_t crc = 0);
+
+  /** The same as Compute, always with the table. */
+  static uint32_t ComputeWithTable(const char *data, size_t size, uint32_t crc = 0);
+
+  /** @return true if Compute uses CPU instructions rather than the table */
+  static bool IsHardware();
+};
+
+}  // namespace bustub
@@ -47,6 +47,8 @@ enum class ExceptionType {
   OUT_OF_MEMORY = 9,
   /** Method not implemented. */
   NOT_IMPLEMENTED = 11,
+  /** A page read from disk does not match its checksum. */
+  CORRUPT_PAGE = 12,
 };
 
 class Exception : public std::runtime_error {
@@ -98,6 +100,8 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::CORRUPT_PAGE:
+        return "Corrupt Page";
       default:
         return "Unknown";
     }
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// per_core_counters.h
+//
+// Identification: src/include/common/per_core_counters.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sched.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * @return the index of the cpu core the calling thread runs on, or a stable per-thread number where the core is not
+ * known. Only a hint: the thread may be moved to another core right after.
+ */
+inline size_t CurrentCore() {
+  const int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return static_cast<size_t>(cpu);
+  }
+  static thread_local const size_t thread_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return thread_hash;
+}
+
+/** @return the number of per-core slots to use: the number of cores, rounded up to a power of two */
+inline size_t NumCoreSlots() {
+  const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+  size_t slots = 1;
+  while (slots < cores) {
+    slots <<= 1;
+  }
+  return slots;
+}
+
+/**
+ * A set of NUM_COUNTERS counters that many threads bump at once. Every core adds to counters on a cache line of its
+ * own, so increments do not bounce a shared cache line between cores; reading a counter sums up all the cores.
+ * Increments are relaxed: a sum taken while counters change is not a consistent snapshot across counters.
+ */
+template <size_t NUM_COUNTERS>
+class PerCoreCounters {
+ public:
+  PerCoreCounters() : num_slots_(NumCoreSlots()), slots_(new Slot[num_slots_]) {}
+
+  DISALLOW_COPY_AND_MOVE(PerCoreCounters);
+
+  /**
+   * Add to a counter.
+   * @param counter index of the counter
+   * @param value the amount to add
+   */
+  void Add(size_t counter, uint64_t value = 1) {
+    slots_[CurrentCore() & (num_slots_ - 1)].values_[counter].fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @param counter index of the counter
+   * @return the sum of the counter over all cores
+   */
+  uint64_t Sum(size_t counter) const {
+    uint64_t sum = 0;
+    for (size_t slot = 0; slot < num_slots_; ++slot) {
+      sum += slots_[slot].values_[counter].load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> values_{};
+  };
+
+  const size_t num_slots_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace bustub
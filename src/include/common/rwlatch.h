@@ -12,25 +12,84 @@
 
 #pragma once
 
+#include <atomic>
 #include <climits>
 #include <condition_variable>  // NOLINT
-#include <mutex>               // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
 
+#include "common/config.h"
 #include "common/macros.h"
+#include "common/per_core_counters.h"
 
 namespace bustub {
 
+/** Tell the cpu that the calling thread is spinning, so that it can yield to its sibling hyperthread. */
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Where latch waiters go once spinning did not help: a mutex and condition variable that are only touched by threads
+ * that have to wait, and by threads releasing a latch while somebody is parked.
+ */
+class LatchParking {
+ public:
+  /** Number of times a waiter checks its condition before it parks. */
+  static constexpr int SPIN_LIMIT = 128;
+
+  /**
+   * Return once ready() is true: spin for a while, then park until woken. ready() must load the latch state with
+   * sequentially consistent ordering, and whoever makes it true must then call WakeAll.
+   */
+  template <class Ready>
+  void Wait(Ready ready) {
+    for (int spin = 0; spin < SPIN_LIMIT; ++spin) {
+      if (ready()) {
+        return;
+      }
+      CpuRelax();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Announced before ready() is checked again, so that a waker either sees this waiter or this waiter sees the
+    // change the waker made.
+    parked_.fetch_add(1);
+    cv_.wait(lock, ready);
+    parked_.fetch_sub(1);
+  }
+
+  /** Wake every parked waiter, after changing the latch state with sequentially consistent ordering. */
+  void WakeAll() {
+    if (parked_.load() > 0) {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      cv_.notify_all();
+    }
+  }
+
+ private:
+  std::atomic<uint32_t> parked_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+/**
+ * Reader-Writer latch on a single atomic word, which holds the number of readers and a writer bit. Uncontended
+ * RLock, RUnlock, WLock and WUnlock are one atomic operation each. A writer sets the writer bit, which turns new
+ * readers away, and then waits for the readers that are in to leave. Waiters spin for a while before they park.
  */
 class ReaderWriterLatch {
-  using mutex_t = std::mutex;
-  using cond_t = std::condition_variable;
-  static const uint32_t MAX_READERS = UINT_MAX;
+  static constexpr uint32_t WRITER = 1U << 31;
+  static constexpr uint32_t READERS = WRITER - 1;
+  static constexpr uint32_t MAX_READERS = READERS;
 
  public:
   ReaderWriterLatch() = default;
-  ~ReaderWriterLatch() { std::lock_guard<mutex_t> guard(mutex_); }
+  ~ReaderWriterLatch() = default;
 
   DISALLOW_COPY(ReaderWriterLatch);
 
@@ -38,59 +97,142 @@ class ReaderWriterLatch {
    * Acquire a write latch.
    */
   void WLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_) {
-      reader_.wait(latch);
-    }
-    writer_entered_ = true;
-    while (reader_count_ > 0) {
-      writer_.wait(latch);
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if ((state & WRITER) == 0) {
+        if (state_.compare_exchange_weak(state, state | WRITER)) {
+          break;
+        }
+        continue;
+      }
+      parking_.Wait([this] { return (state_.load() & WRITER) == 0; });
+      state = state_.load(std::memory_order_relaxed);
     }
+    parking_.Wait([this] { return (state_.load() & READERS) == 0; });
   }
 
   /**
    * Release a write latch.
    */
   void WUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    writer_entered_ = false;
-    reader_.notify_all();
+    state_.fetch_and(~WRITER);
+    parking_.WakeAll();
   }
 
   /**
    * Acquire a read latch.
    */
   void RLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_ || reader_count_ == MAX_READERS) {
-      reader_.wait(latch);
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if ((state & WRITER) == 0 && (state & READERS) != MAX_READERS) {
+        if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+          return;
+        }
+        continue;
+      }
+      parking_.Wait([this] {
+        const uint32_t state = state_.load();
+        return (state & WRITER) == 0 && (state & READERS) != MAX_READERS;
+      });
+      state = state_.load(std::memory_order_relaxed);
     }
-    reader_count_++;
   }
 
   /**
    * Release a read latch.
    */
   void RUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    reader_count_--;
-    if (writer_entered_) {
-      if (reader_count_ == 0) {
-        writer_.notify_one();
-      }
-    } else {
-      if (reader_count_ == MAX_READERS - 1) {
-        reader_.notify_one();
+    const uint32_t state = state_.fetch_sub(1);
+    // The last reader out lets a waiting writer in; a reader leaving a full latch lets another reader in.
+    if (((state & WRITER) != 0 && (state & READERS) == 1) || (state & READERS) == MAX_READERS) {
+      parking_.WakeAll();
+    }
+  }
+
+ private:
+  std::atomic<uint32_t> state_{0};
+  LatchParking parking_;
+};
+
+/**
+ * Reader-Writer latch for latches that are read latched much more often than write latched. Every core counts its
+ * readers on a cache line of its own, so readers on different cores do not write to the same cache line; in exchange
+ * a writer has to look at every core's count, and the latch takes a cache line per core.
+ */
+class PerCoreReaderWriterLatch {
+ public:
+  PerCoreReaderWriterLatch() : num_slots_(NumCoreSlots()), slots_(new Slot[num_slots_]) {}
+  ~PerCoreReaderWriterLatch() = default;
+
+  DISALLOW_COPY(PerCoreReaderWriterLatch);
+
+  /**
+   * Acquire a write latch.
+   */
+  void WLock() {
+    writer_mutex_.lock();
+    writer_.store(true);
+    parking_.Wait([this] { return NumReaders() == 0; });
+  }
+
+  /**
+   * Release a write latch.
+   */
+  void WUnlock() {
+    writer_.store(false);
+    parking_.WakeAll();
+    writer_mutex_.unlock();
+  }
+
+  /**
+   * Acquire a read latch.
+   */
+  void RLock() {
+    while (true) {
+      std::atomic<int64_t> &readers = slots_[CurrentCore() & (num_slots_ - 1)].readers_;
+      readers.fetch_add(1);
+      if (!writer_.load()) {
+        return;
       }
+      // A writer is in or on its way in: step back, and let it know in case it saw this reader.
+      readers.fetch_sub(1);
+      parking_.WakeAll();
+      parking_.Wait([this] { return !writer_.load(); });
+    }
+  }
+
+  /**
+   * Release a read latch. The thread may have moved to another core since RLock; only the sum of the counts matters.
+   */
+  void RUnlock() {
+    slots_[CurrentCore() & (num_slots_ - 1)].readers_.fetch_sub(1);
+    if (writer_.load()) {
+      parking_.WakeAll();
     }
   }
 
  private:
-  mutex_t mutex_;
-  cond_t writer_;
-  cond_t reader_;
-  uint32_t reader_count_{0};
-  bool writer_entered_{false};
+  struct alignas(CACHE_LINE_SIZE) Slot {
+    std::atomic<int64_t> readers_{0};
+  };
+
+  /** @return the number of readers in, or on their way in. Never 0 while a reader holds the latch. */
+  int64_t NumReaders() const {
+    int64_t readers = 0;
+    for (size_t slot = 0; slot < num_slots_; ++slot) {
+      readers += slots_[slot].readers_.load();
+    }
+    return readers;
+  }
+
+  const size_t num_slots_;
+  std::unique_ptr<Slot[]> slots_;
+  /** Set while a writer holds the latch or waits for the readers to leave. */
+  std::atomic<bool> writer_{false};
+  /** Serializes writers. */
+  std::mutex writer_mutex_;
+  LatchParking parking_;
 };
 
 }  // namespace bustub
@@ -102,7 +102,7 @@ class TransactionManager {
   LogManager *log_manager_ __attribute__((__unused__));
 
   /** The global transaction latch is used for checkpointing. */
-  ReaderWriterLatch global_txn_latch_;
+  PerCoreReaderWriterLatch global_txn_latch_;
 };
 
 }  // namespace bustub
@@ -171,7 +171,7 @@ class ExtendibleHashTable {
   KeyComparator comparator_;
 
   // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
+  PerCoreReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
 
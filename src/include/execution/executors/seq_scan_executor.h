@@ -17,12 +17,14 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ * Pages are fetched with AccessType::Scan, so a scan recycles a few buffer pool frames instead of evicting the pool.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -50,5 +52,9 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  TableInfo *table_info_;
+  /** The position of the scan in the table */
+  TableIterator iter_;
 };
 }  // namespace bustub
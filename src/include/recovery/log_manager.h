@@ -17,6 +17,7 @@
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
 
+#include "common/bustub_config.h"
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
 
@@ -28,10 +29,17 @@ namespace bustub {
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+  /**
+   * @param disk_manager the disk manager the log is written to
+   * @param config the log buffer and the flush buffer are config.log_buffer_size_ bytes each
+   */
+  explicit LogManager(DiskManager *disk_manager, const BustubConfig &config = BustubConfig())
+      : next_lsn_(0),
+        persistent_lsn_(INVALID_LSN),
+        log_buffer_size_(config.log_buffer_size_),
+        disk_manager_(disk_manager) {
+    log_buffer_ = new char[log_buffer_size_];
+    flush_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogManager() {
@@ -50,6 +58,7 @@ class LogManager {
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
+  inline size_t GetLogBufferSize() const { return log_buffer_size_; }
 
  private:
   // TODO(students): you may add your own member variables
@@ -59,6 +68,8 @@ class LogManager {
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
+  /** Size of log_buffer_ and flush_buffer_ in bytes. */
+  size_t log_buffer_size_;
   char *log_buffer_;
   char *flush_buffer_;
 
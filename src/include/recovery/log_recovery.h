@@ -17,6 +17,7 @@
 #include <unordered_map>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/bustub_config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/log_record.h"
 
@@ -27,9 +28,18 @@ namespace bustub {
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+  /**
+   * @param disk_manager the disk manager the log is read from
+   * @param buffer_pool_manager the buffer pool the log is replayed into
+   * @param config must match the configuration the log was written with, so that every log record fits the buffer
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager,
+              const BustubConfig &config = BustubConfig())
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        offset_(0),
+        log_buffer_size_(config.log_buffer_size_) {
+    log_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogRecovery() {
@@ -51,6 +61,7 @@ class LogRecovery {
   std::unordered_map<lsn_t, int> lsn_mapping_;
 
   int offset_ __attribute__((__unused__));
+  size_t log_buffer_size_ __attribute__((__unused__));
   char *log_buffer_;
 };
 
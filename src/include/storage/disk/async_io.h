@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.h
+//
+// Identification: src/include/storage/disk/async_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstdlib>
+#include <future>  // NOLINT
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Frees memory from aligned_alloc. */
+struct AlignedFree {
+  void operator()(char *data) const { free(data); }
+};
+
+/** A buffer from aligned_alloc, for I/O on files opened with O_DIRECT. */
+using AlignedBuffer = std::unique_ptr<char, AlignedFree>;
+
+/**
+ * A positioned read or write of one buffer, owned by the AsyncIO backend from Queue until it completes. The buffer
+ * must stay valid until then.
+ */
+struct AsyncIORequest {
+  bool is_write_;
+  int fd_;
+  char *data_;
+  size_t size_;
+  int64_t offset_;
+  /** Set to true once the request completed successfully. A read past the end of the file is zero-filled. */
+  std::promise<bool> done_;
+  /** Scratch space for the io_uring backend, which submits the buffer as a one-element vector. */
+  struct iovec iov_;
+  /** Owns data_ if it is an aligned copy of the caller's buffer, which O_DIRECT needs. */
+  AlignedBuffer bounce_;
+  /** If set, a successful read is copied from data_ to here. */
+  char *copy_to_ = nullptr;
+};
+
+/**
+ * AsyncIO runs reads and writes in the background and keeps many of them in flight at once. Requests are queued
+ * first and only started by Submit, so that a batch of them costs a single system call.
+ *
+ * There are two backends: io_uring, which hands the whole batch to the kernel, and a pool of threads running
+ * pread/pwrite, for kernels (or sandboxes) without io_uring.
+ */
+class AsyncIO {
+ public:
+  virtual ~AsyncIO() = default;
+
+  /**
+   * Create an AsyncIO backend. Falls back to the thread pool if io_uring is not wanted or not available.
+   * @param use_io_uring true to try io_uring first
+   * @param queue_depth the maximum number of requests in flight
+   * @return the backend
+   */
+  static std::unique_ptr<AsyncIO> Create(bool use_io_uring, size_t queue_depth);
+
+  /**
+   * Queue a request. It is not started before the next Submit, unless the queue is full.
+   * @param request the request, owned by the backend from now on
+   */
+  virtual void Queue(std::unique_ptr<AsyncIORequest> request) = 0;
+
+  /**
+   * Start every queued request.
+   */
+  virtual void Submit() = 0;
+
+  /** @return true if this backend uses io_uring */
+  virtual bool IsIoUring() const = 0;
+
+ protected:
+  /**
+   * Complete a request with the result of its read or write, and destroy it.
+   * @param request the request
+   * @param result number of bytes transferred, or a negative errno
+   */
+  static void Complete(std::unique_ptr<AsyncIORequest> request, int64_t result);
+};
+
+}  // namespace bustub
@@ -12,19 +12,54 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 
 #include "common/config.h"
+#include "storage/disk/async_io.h"
+#include "storage/disk/free_page_map.h"
+#include "storage/disk/page_checksum_table.h"
+#include "storage/disk/page_mapping_table.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread/pwrite on a file descriptor, which carry their own offset, so concurrent page
+ * I/O from different buffer pool instances needs no latch. The size of the database file is cached and only grows.
+ *
+ * The database is split into segment files of segment_pages pages each, so that no single file grows without bound
+ * and segments can be spread over devices (a segment file may be a symlink). Segment 0 is the db file itself, segment
+ * s > 0 is <db file>.<s>. Segments are opened on first use and created in order, so the segments of a database are
+ * the files up to the first one missing. Disk space is preallocated with fallocate DB_PREALLOCATE_PAGES at a time
+ * ahead of the writes, which keeps a growing segment from fragmenting.
+ *
+ * ReadPageAsync and WritePageAsync queue page I/O on an AsyncIO backend (io_uring, or a thread pool where io_uring is
+ * not available), which is created on first use. Queued requests start on SubmitAsync, so a batch of them costs one
+ * system call.
+ *
+ * If enable_direct_io is set, the database file is opened with O_DIRECT so that pages are cached only by the buffer
+ * pool and not a second time by the kernel. O_DIRECT needs aligned buffers: buffer pool frames are, and other buffers
+ * go through an aligned copy. If the file system rejects O_DIRECT, the disk manager falls back to buffered I/O.
+ *
+ * Free page ids are tracked in free page maps next to the database file, one per buffer pool instance, in the same
+ * way as the log lives next to it.
+ *
+ * If enable_page_compression is set when a database file is created, its pages are compressed with Lz4Codec on the
+ * way to disk and decompressed on the way back, and packed into the file through a PageMappingTable that lives next to
+ * it. A page that does not compress by at least a sector is stored as it is. Whether an existing file is compressed
+ * is decided by whether it has a page mapping table, not by the flag. Compressed files are never opened with O_DIRECT,
+ * and their asynchronous reads and writes complete before ReadPageAsync and WritePageAsync return.
+ *
+ * Page checksums that buffer pools compute are kept in a PageChecksumTable next to the database file, which is
+ * created on the first checksum written.
  */
 class DiskManager {
  public:
@@ -32,9 +67,16 @@ class DiskManager {
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file) : DiskManager(db_file, DB_SEGMENT_PAGES) {}
 
-  ~DiskManager() = default;
+  /**
+   * Creates a new disk manager that writes to the specified database file, split into segments of the given size.
+   * @param db_file the file name of the database file to write to
+   * @param segment_pages number of pages per segment file; must be the same every time the database is opened
+   */
+  DiskManager(const std::string &db_file, size_t segment_pages);
+
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -55,6 +97,87 @@ class DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Queue an asynchronous write of a page. It starts on the next SubmitAsync.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the write completes
+   * @return a future that is set to true when the write completed successfully
+   */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Queue an asynchronous read of a page. It starts on the next SubmitAsync.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the read completes
+   * @return a future that is set to true when the read completed successfully
+   */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Start every queued asynchronous read and write.
+   */
+  void SubmitAsync();
+
+  /** @return true if asynchronous I/O goes through io_uring */
+  bool IsAsyncIoUring();
+
+  /** @return true if the database file is accessed with O_DIRECT */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /** @return true if the pages of the database file are compressed */
+  bool IsPageCompression() const { return page_mapping_table_ != nullptr; }
+
+  /**
+   * Map the database file into memory, read-only, as it is at the first call; later calls return the same mapping. The
+   * segments are mapped next to each other, so page p is at offset p * PAGE_SIZE. The mapping stays valid until the
+   * disk manager is shut down. Writing to it crashes the process.
+   * @param[out] size size of the mapping in bytes
+   * @return the mapping, nullptr if the file is empty, compressed or cannot be mapped
+   */
+  const char *MapReadOnly(size_t *size);
+
+  /**
+   * Record in the page checksum table <db file>.crc that a page is about to be written with a checksum. Until its
+   * checksum is stored, the page is reported as pending instead of being checked against its previous checksum.
+   * @param page_id id of the page
+   */
+  void MarkChecksumPending(page_id_t page_id);
+
+  /**
+   * Store the checksum of a page, in the page checksum table <db file>.crc.
+   * @param page_id id of the page
+   * @param checksum checksum of the page data, stored once its write completed
+   */
+  void WriteChecksum(page_id_t page_id, uint32_t checksum);
+
+  /**
+   * Remove the checksum of a page, which is about to be written without one or was deallocated.
+   * @param page_id id of the page
+   */
+  void ClearChecksum(page_id_t page_id);
+
+  /**
+   * Look up the checksum of a page.
+   * @param page_id id of the page
+   * @param[out] checksum checksum of the page as it was last written
+   * @return false if the page was not written with a checksum, or its last write with one may not have completed
+   */
+  bool ReadChecksum(page_id_t page_id, uint32_t *checksum);
+
+  /**
+   * @param page_id id of the page
+   * @return true if a write of the page was marked pending and its checksum was never stored, as happens when the
+   * process stops during the write
+   */
+  bool IsChecksumPending(page_id_t page_id);
+
+  /**
+   * Open the free page map of a buffer pool instance, in the file <db file>.fsm.<shard>.
+   * @param shard the index of the buffer pool instance
+   * @return the free page map
+   */
+  std::unique_ptr<FreePageMap> OpenFreePageMap(uint32_t shard);
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -80,6 +203,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of page reads, synchronous or asynchronous */
+  int GetNumReads() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -90,19 +216,103 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
+  /** A segment file of the database. */
+  struct Segment {
+    // file descriptor, -1 until the segment is opened
+    std::atomic<int> fd_{-1};
+    // disk space is allocated for the file up to here
+    std::atomic<int64_t> preallocated_{0};
+  };
+  static constexpr size_t SEGMENTS_PER_CHUNK = 256;
+  /** Segments are allocated in chunks, which are never freed before the disk manager, so lookups need no latch. */
+  struct SegmentChunk {
+    std::array<Segment, SEGMENTS_PER_CHUNK> segments_;
+  };
+
+  int64_t GetFileSize(const std::string &file_name);
+  /** @return the file name of a segment */
+  std::string GetSegmentName(size_t segment) const;
+  /**
+   * Find the segment of a page, opening its file on first use.
+   * @param page_id id of the page
+   * @param create true to create the file (and the missing segments before it) if it does not exist
+   * @return the segment, nullptr if its file does not exist and create is false, or cannot be opened
+   */
+  Segment *GetSegment(page_id_t page_id, bool create);
+  /** @return the offset of a page within its segment file */
+  int64_t GetSegmentOffset(page_id_t page_id) const {
+    return static_cast<int64_t>(static_cast<size_t>(page_id) % segment_pages_) * PAGE_SIZE;
+  }
+  /** Open a segment file, with O_DIRECT while direct_io_ is set. @return the file descriptor, -1 on failure */
+  int OpenSegmentFile(const std::string &file_name, bool create);
+  /** Make sure disk space is allocated for the page at offset of a segment before writing it. */
+  void Preallocate(Segment *segment, int64_t offset);
+  /** Close the db file and every segment file. */
+  void CloseSegments();
+  /** @return the file name of the free page map of a buffer pool instance */
+  std::string GetFreePageMapName(uint32_t shard) const;
+  /** @return the file name of the page mapping table of a compressed database file */
+  std::string GetPageMappingTableName() const { return file_name_ + ".map"; }
+  /** @return the page checksum table, created if there is none; nullptr once the disk manager is shut down */
+  PageChecksumTable *GetChecksumTable();
+
+  /** @return the file name of the page checksum table */
+  std::string GetPageChecksumTableName() const { return file_name_ + ".crc"; }
+  /** Compress a page and write it to its extent. @return false on an I/O error */
+  bool WriteCompressedPage(page_id_t page_id, const char *page_data);
+  /** Read a page from its extent and decompress it. @return false on an I/O error or a corrupt page */
+  bool ReadCompressedPage(page_id_t page_id, char *page_data);
+  /** @return the asynchronous I/O backend, created on first use */
+  AsyncIO *GetAsyncIO();
+  /** Record that the db file extends at least to the end of the page at offset. */
+  void GrowFileSize(int64_t offset);
+  /**
+   * Switch a segment file from O_DIRECT to buffered I/O after the file system rejected an O_DIRECT read or write.
+   * Segment files opened later use buffered I/O as well.
+   * @param fd file descriptor of the segment file
+   * @return true if the failed I/O should be retried once
+   */
+  bool DisableDirectIO(int fd);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file, which is segment 0, -1 once shut down
+  int db_fd_;
+  // number of pages per segment file
+  const size_t segment_pages_;
+  // the segments, in chunks allocated on first use
+  std::unique_ptr<std::atomic<SegmentChunk *>[]> segment_chunks_;
+  size_t num_segment_chunks_;
+  // serializes opening and creating segment files
+  std::mutex segment_latch_;
+  // cleared if the file system does not support fallocate
+  std::atomic<bool> preallocate_{true};
+  // true while segment files are opened with O_DIRECT
+  std::atomic<bool> direct_io_{false};
+  // size of the database in bytes over all its segments, kept up to date by WritePage
+  std::atomic<int64_t> db_file_size_;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // where the pages of a compressed db file are, nullptr if the db file is not compressed
+  std::unique_ptr<PageMappingTable> page_mapping_table_;
+  // serialize the reads and writes of a compressed page, striped by page id, so that a read does not see the extent
+  // of a page that is being moved
+  std::array<std::mutex, 64> compressed_page_latches_;
+  // checksums of the pages written with one, nullptr until the first
+  std::atomic<PageChecksumTable *> checksum_table_{nullptr};
+  // serializes creating and closing the page checksum table
+  std::mutex checksum_table_latch_;
+  // read-only mapping of the db file, nullptr unless MapReadOnly mapped it
+  char *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  std::once_flag mapping_once_;
+  // backend for asynchronous page I/O, nullptr until first used
+  std::unique_ptr<AsyncIO> async_io_;
+  std::once_flag async_io_once_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap keeps track of the page ids a buffer pool instance can hand out, in a file next to the database file.
+ * It holds a bitmap of the page ids that were deallocated and can be reused, and the page id that allocation continues
+ * from after a restart. Every buffer pool instance has a map of its own (a shard), so that allocation in one instance
+ * never waits for another.
+ *
+ * The file starts with a header block, followed by bitmap blocks of PAGE_SIZE bytes each. A missing or unreadable file
+ * gives an empty map.
+ *
+ * FreePageMap is not thread-safe; the buffer pool instance serializes access to it.
+ */
+class FreePageMap {
+ public:
+  /**
+   * Open the free page map in file_name, creating the file if it does not exist.
+   * @param file_name the file of the map
+   * @throws Exception if the file cannot be opened
+   */
+  explicit FreePageMap(const std::string &file_name);
+
+  /** Write out the map and close its file. */
+  ~FreePageMap();
+
+  DISALLOW_COPY_AND_MOVE(FreePageMap);
+
+  /** @return the page id to continue allocating from: past every page id handed out before, even before a restart */
+  page_id_t GetNextPageId() const { return reserved_page_id_; }
+
+  /**
+   * Record that a new page id is handed out. To keep allocation from going back after a restart, the map persists a
+   * page id PAGE_ID_RESERVATION ids ahead whenever page_id reaches the persisted one.
+   * @param page_id the page id
+   */
+  void Reserve(page_id_t page_id);
+
+  /**
+   * Mark a page id as free. This is written out lazily: a free page id that is lost in a crash is only leaked.
+   * @param page_id the page id
+   */
+  void Free(page_id_t page_id);
+
+  /**
+   * Take the lowest free page id that can be used. This is written out immediately: a page id that is in use but still
+   * free on disk could be handed out twice after a crash.
+   * @param[out] page_id the page id
+   * @param usable returns false for free page ids the caller cannot hand out
+   * @return false if there is no usable free page id
+   */
+  bool Reuse(page_id_t *page_id, const std::function<bool(page_id_t)> &usable);
+
+  /** @return the number of free page ids */
+  size_t GetNumFree() const { return num_free_; }
+
+  /** Write out every change to the map. */
+  void Flush();
+
+ private:
+  /** Number of page ids covered by one bitmap block. */
+  static constexpr size_t PAGES_PER_BLOCK = PAGE_SIZE * 8;
+  /** Number of bitmap words in one block. */
+  static constexpr size_t WORDS_PER_BLOCK = PAGE_SIZE / sizeof(uint64_t);
+
+  void WriteHeader();
+  void WriteBlock(size_t block);
+
+  int fd_;
+  /** Persisted page id allocation continues from; every page id handed out is below it. */
+  page_id_t reserved_page_id_ = 0;
+  /** Bit i is set if page id i is free. Always a whole number of blocks. */
+  std::vector<uint64_t> words_;
+  /** Blocks with frees that are not written out yet. */
+  std::vector<bool> dirty_blocks_;
+  /** Lowest word that may have a bit set. */
+  size_t first_free_word_ = 0;
+  size_t num_free_ = 0;
+};
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4_codec.h
+//
+// Identification: src/include/storage/disk/lz4_codec.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * Lz4Codec compresses buffers into the LZ4 block format: a series of sequences, each a run of literal bytes followed
+ * by a copy of earlier output. The compressor only looks for matches through a small hash table of 4-byte sequences,
+ * which makes it fast rather than thorough, like the default level of LZ4. The output can be decompressed by any LZ4
+ * block decoder, and the decompressor checks every length and offset, so corrupt input fails instead of overrunning.
+ */
+class Lz4Codec {
+ public:
+  /**
+   * Compress a buffer.
+   * @param src the data to compress
+   * @param src_size size of the data
+   * @param[out] dst output buffer
+   * @param dst_capacity size of the output buffer
+   * @return size of the compressed data, or 0 if it does not fit into dst_capacity bytes
+   */
+  static size_t Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity);
+
+  /**
+   * Decompress a buffer that was compressed by Compress.
+   * @param src the compressed data
+   * @param src_size size of the compressed data
+   * @param[out] dst output buffer
+   * @param dst_size size of the data before it was compressed
+   * @return true if src was well-formed and decompressed to exactly dst_size bytes
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dst, size_t dst_size);
+};
+
+}  // namespace bustub
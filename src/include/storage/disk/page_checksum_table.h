@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksum_table.h
+//
+// Identification: src/include/storage/disk/page_checksum_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageChecksumTable holds the CRC-32C of every page of a database that was written with a checksum. Every byte of a
+ * page belongs to its page format, so the checksums are kept out of band, in a file next to the database file: the
+ * entry of page id i is the 8 bytes at offset i * 8, the checksum in the low half and flags above it.
+ *
+ * The checksum of a page is stored only after the page write completed. Before the write goes out its entry is marked
+ * pending, so that a page whose write was cut short by a crash is known to need redo instead of being taken for a
+ * corrupt one.
+ *
+ * Lookups are served from memory, so verifying a page read costs no extra I/O. The entries are loaded in chunks of
+ * PAGES_PER_CHUNK page ids on first use, and written through on every change.
+ *
+ * PageChecksumTable is thread-safe.
+ */
+class PageChecksumTable {
+ public:
+  /** Number of page ids whose entries are loaded at a time. */
+  static constexpr size_t PAGES_PER_CHUNK = 65536;
+
+  /**
+   * Open the page checksum table in file_name, creating the file if it does not exist.
+   * @param file_name the file of the table
+   * @throws Exception if the file cannot be opened
+   */
+  explicit PageChecksumTable(const std::string &file_name);
+
+  /** Close the file of the table. */
+  ~PageChecksumTable();
+
+  DISALLOW_COPY_AND_MOVE(PageChecksumTable);
+
+  /**
+   * Look up the checksum of a page.
+   * @param page_id the page id
+   * @param[out] checksum the checksum
+   * @return false if the page has no checksum, or a write of it is pending
+   */
+  bool Find(page_id_t page_id, uint32_t *checksum);
+
+  /**
+   * @param page_id the page id
+   * @return true if a write of the page went out and its checksum was not stored after it
+   */
+  bool IsPending(page_id_t page_id);
+
+  /**
+   * Mark a write of a page pending, before the write goes out.
+   * @param page_id the page id
+   * @return false on an I/O error
+   */
+  bool MarkPending(page_id_t page_id);
+
+  /**
+   * Set the checksum of a page, which also ends a pending write of it.
+   * @param page_id the page id
+   * @param checksum the checksum of the page as it was written
+   * @return false on an I/O error
+   */
+  bool Store(page_id_t page_id, uint32_t checksum);
+
+  /**
+   * Remove the checksum of a page, which is about to be written without one or was deallocated.
+   * @param page_id the page id
+   * @return false on an I/O error
+   */
+  bool Clear(page_id_t page_id);
+
+ private:
+  /** Set in an entry that holds a checksum. */
+  static constexpr uint64_t ENTRY_SET = uint64_t{1} << 32;
+  /** Set in an entry whose page is being written, until its checksum is stored. */
+  static constexpr uint64_t ENTRY_PENDING = uint64_t{1} << 33;
+
+  /** @return the entry of a page id in memory, loading its chunk first if needed; nullptr for invalid page ids */
+  std::atomic<uint64_t> *GetEntry(page_id_t page_id);
+
+  /** Change the entry of a page id in memory and in the file. */
+  bool Write(page_id_t page_id, uint64_t entry);
+
+  int fd_;
+  /** The chunks of entries, nullptr until loaded. */
+  std::unique_ptr<std::atomic<std::atomic<uint64_t> *>[]> chunks_;
+  size_t num_chunks_;
+  /** Serializes loading chunks. */
+  std::mutex chunk_latch_;
+  /** Serialize the writes of an entry, striped by page id, so that memory and the file agree. */
+  std::array<std::mutex, 64> entry_latches_;
+};
+
+}  // namespace bustub
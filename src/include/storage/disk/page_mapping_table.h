@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_mapping_table.h
+//
+// Identification: src/include/storage/disk/page_mapping_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageMappingTable records where every page of a compressed database file is stored. Compressed pages differ in size,
+ * so they cannot sit at page_id * PAGE_SIZE; instead they are packed into extents of whole sectors, and the table maps
+ * every page id to its extent. A page that is written again stays in its extent if it still needs the same number of
+ * sectors, and moves to another one otherwise. Extents that are given up are reused for pages of the same size or
+ * smaller; the database file only grows when no free extent is large enough.
+ *
+ * The table lives in a file next to the database file: a header entry, followed by the entry of page id i at entry
+ * i + 1. Entries are written through as soon as a page has been written, after its data. The extent a page moves away
+ * from is only given up once its new entry is written, so that the entry in the file never points to an extent that
+ * already holds another page. Free extents are not stored, they are the gaps between the extents in use when the table
+ * is opened.
+ *
+ * PageMappingTable is thread-safe. Concurrent writes of the same page id must be serialized by the caller.
+ */
+class PageMappingTable {
+ public:
+  /** Extents are whole sectors, so that a page that shrinks or grows a little can stay where it is. */
+  static constexpr size_t SECTOR_SIZE = 512;
+
+  /** Where a page is stored. */
+  struct Entry {
+    /** Byte offset of the extent in the database file. */
+    uint64_t offset_;
+    /** Number of bytes stored, 0 if the page was never written. */
+    uint32_t size_;
+    /** 1 if the stored bytes are compressed, 0 if they are the page itself. */
+    uint32_t compressed_;
+  };
+
+  /**
+   * Open the page mapping table in file_name, creating the file if it does not exist.
+   * @param file_name the file of the table
+   * @param create true to start out with an empty table, for a new database file
+   * @throws Exception if the file cannot be opened, or is not a page mapping table
+   */
+  PageMappingTable(const std::string &file_name, bool create);
+
+  /** Close the file of the table. */
+  ~PageMappingTable();
+
+  DISALLOW_COPY_AND_MOVE(PageMappingTable);
+
+  /**
+   * Look up where a page is stored.
+   * @param page_id the page id
+   * @param[out] entry where the page is stored
+   * @return false if the page was never written
+   */
+  bool Find(page_id_t page_id, Entry *entry);
+
+  /**
+   * Pick the extent for the next version of a page, and record it in memory. The caller writes the page there and then
+   * calls Persist. If the page moves, its old extent is kept until Persist.
+   * @param page_id the page id
+   * @param size number of bytes to store, at most PAGE_SIZE
+   * @param compressed true if the bytes are compressed
+   * @return where to write the page
+   */
+  Entry Place(page_id_t page_id, uint32_t size, bool compressed);
+
+  /**
+   * Write the entry of a page to the file of the table, and give up the extent the page moved away from.
+   * @param page_id the page id
+   * @return false on an I/O error
+   */
+  bool Persist(page_id_t page_id);
+
+  /** @return the number of bytes of the database file that are in use by extents, free or not */
+  uint64_t GetDataSize();
+
+ private:
+  static constexpr size_t SECTORS_PER_PAGE = (PAGE_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+  static size_t GetNumSectors(uint32_t size) { return (size + SECTOR_SIZE - 1) / SECTOR_SIZE; }
+
+  /**
+   * Take a free extent of num_sectors sectors, or a new one at the end of the data. Must be called with latch_ held.
+   * @return the offset of the extent
+   */
+  uint64_t AllocateExtent(size_t num_sectors);
+
+  /** Give up an extent. Must be called with latch_ held. */
+  void FreeExtent(uint64_t offset, size_t num_sectors);
+
+  int fd_;
+  std::mutex latch_;
+  /** Entry of every page id that was ever mapped. */
+  std::vector<Entry> entries_;
+  /** Offsets of the free extents, by number of sectors. */
+  std::vector<std::vector<uint64_t>> free_extents_;
+  /** Offset and number of sectors of the extent the persisted entry of a page still points to, until Persist. */
+  std::unordered_map<page_id_t, std::pair<uint64_t, size_t>> retiring_extents_;
+  /** End of the last extent; new extents are appended here. */
+  uint64_t data_size_ = 0;
+};
+
+}  // namespace bustub
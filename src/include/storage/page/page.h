@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -24,14 +25,25 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data itself lives in the frame arena of the buffer pool, so that it is page-aligned and does not share cache
+ * lines with the book-keeping, which is aligned to a cache line of its own. Pages of a MmapBufferPoolManager are views
+ * into a read-only mapping of the database file instead.
+ *
+ * Besides the latch, a page has a version that makes optimistic reads possible: it is odd while the page is being
+ * written, and changes with every write. A reader notes an even version, reads without latching, and then checks
+ * that the version did not change, which costs no write to shared memory. Writes under the write latch and the
+ * buffer pool moving pages into and out of the frame bump the version; other writes are not seen by optimistic
+ * readers.
  */
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The buffer pool attaches the page to its frame data. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -39,6 +51,9 @@ class Page {
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
 
+  /** @return the actual data contained within this page, read-only */
+  inline const char *GetData() const { return data_; }
+
   /** @return the page id of this page */
   inline page_id_t GetPageId() { return page_id_; }
 
@@ -49,10 +64,16 @@ class Page {
   inline bool IsDirty() { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    BeginWrite();
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    EndWrite();
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -66,6 +87,20 @@ class Page {
   /** Sets the page LSN. */
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
+  /** @return the version of the page, to start an optimistic read with; odd while the page is being written */
+  inline uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Finish an optimistic read.
+   * @param version the version returned by GetVersion before the read
+   * @return true if the page was not written since, so that what was read is consistent
+   */
+  inline bool ValidateVersion(uint64_t version) const {
+    // Keeps the reads of the page contents from moving past the second load of the version.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
  protected:
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
@@ -75,17 +110,31 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Make the version odd before writing the page. Only one thread at a time may write the page. */
+  inline void BeginWrite() {
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // Keeps the writes to the page contents from moving before the version change.
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /** Make the version even again after writing the page. */
+  inline void EndWrite() { version_.fetch_add(1, std::memory_order_release); }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE bytes in the frame arena or the mapped file. */
+  char *data_{nullptr};
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page. Negative while the buffer pool is moving the page into or out of its frame. */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** Set whenever the page is fetched; cleared when the buffer pool passes over it while looking for a victim. */
+  std::atomic<bool> ref_bit_{false};
+  /** Changes with every write of the page, odd while it is being written. */
+  std::atomic<uint64_t> version_{0};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
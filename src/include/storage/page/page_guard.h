@@ -0,0 +1,272 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <type_traits>
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard holds the pin of a page and unpins it when it goes out of scope, marking the page dirty if it was
+ * changed through the guard. It does not latch the page; ReadPageGuard and WritePageGuard do.
+ *
+ * Guards are move-only. Moving a guard hands over the pin, and assigning to a guard first releases what it held, so a
+ * loop can carry a guard from one page to the next, or keep a page pinned between iterations and only latch it when
+ * it looks at it.
+ *
+ * A guard is empty if the buffer pool could not fetch the page, after it was moved from, and after Drop.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Release the page this guard holds, then take over the page of that. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpin the page, if the guard holds one, and leave the guard empty. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  explicit operator bool() const { return page_ != nullptr; }
+
+  /** @return the id of the page, INVALID_PAGE_ID if the guard is empty */
+  page_id_t PageId() const { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  /** @return the page itself, nullptr if the guard is empty */
+  Page *GetPage() const { return page_; }
+
+  /** @return the page contents, read-only */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the page contents, and marks the page dirty */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** Mark the page dirty, for changes made through As that GetDataMut and AsMut do not see. */
+  void MarkDirty() { is_dirty_ = true; }
+
+  /**
+   * @return the page as a T: the page itself for page types derived from Page, like TablePage, and the page contents
+   * for the others, like BPlusTreePage. For reading only, as writes through it do not mark the page dirty.
+   */
+  template <class T>
+  T *As() const {
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return static_cast<T *>(page_);
+    } else {
+      return reinterpret_cast<T *>(page_->GetData());
+    }
+  }
+
+  /** @return the page as a T like As, and marks the page dirty */
+  template <class T>
+  T *AsMut() {
+    is_dirty_ = true;
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return static_cast<T *>(page_);
+    } else {
+      return reinterpret_cast<T *>(page_->GetData());
+    }
+  }
+
+  /**
+   * Take the read latch of the page, handing the pin over to the returned guard. This guard is left empty.
+   * @return the read guard
+   */
+  ReadPageGuard UpgradeRead();
+
+  /**
+   * Take the write latch of the page, handing the pin over to the returned guard. This guard is left empty.
+   * @return the write guard
+   */
+  WritePageGuard UpgradeWrite();
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds the pin and the read latch of a page, and releases both when it goes out of scope.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /** Take over the pin of a page whose read latch the caller holds. */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** Release the page this guard holds, then take over the page of that. */
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Unlatch and unpin the page, if the guard holds one, and leave the guard empty. */
+  void Drop();
+
+  /**
+   * Release the read latch but keep the page pinned, for a caller that comes back to the page later. This guard is
+   * left empty.
+   * @return a guard holding the pin
+   */
+  BasicPageGuard Unlatch();
+
+  /** @return true if the guard holds a page */
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  /** @return the id of the page, INVALID_PAGE_ID if the guard is empty */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the page contents */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the page as a T, read-only as only the read latch is held; see BasicPageGuard::As */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds the pin and the write latch of a page, and releases both when it goes out of scope. The page
+ * is marked dirty once it has been accessed through GetDataMut or AsMut.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /** Take over the pin of a page whose write latch the caller holds. */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** Release the page this guard holds, then take over the page of that. */
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Unlatch and unpin the page, if the guard holds one, and leave the guard empty. */
+  void Drop();
+
+  /**
+   * Release the write latch but keep the page pinned and its dirty mark, for a caller that comes back to the page
+   * later. This guard is left empty.
+   * @return a guard holding the pin
+   */
+  BasicPageGuard Unlatch();
+
+  /** @return true if the guard holds a page */
+  explicit operator bool() const { return static_cast<bool>(guard_); }
+
+  /** @return the id of the page, INVALID_PAGE_ID if the guard is empty */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the page contents, read-only */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the page contents, and marks the page dirty */
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  /** Mark the page dirty, for changes made through As that GetDataMut and AsMut do not see. */
+  void MarkDirty() { guard_.MarkDirty(); }
+
+  /** @return the page as a T for reading, see BasicPageGuard::As */
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the page as a T, and marks the page dirty */
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * OptimisticPageGuard is an optimistic read of a resident page: it holds neither a pin nor a latch, and fetching the
+ * page through it writes nothing to shared memory. The page may be written or even replaced by another page while it
+ * is read, so the reader must copy out what it needs, must not follow anything it read before validating, and must be
+ * ready for garbage. Validate then tells whether what was read is consistent; if not, the reader retries or falls
+ * back to FetchPageRead.
+ *
+ * The guard is empty if the page was not resident or was being written.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+
+  /** Start an optimistic read of page at version, which was even when the page held page_id. */
+  OptimisticPageGuard(Page *page, uint64_t version) : page_(page), version_(version) {}
+
+  /** @return true if the guard holds a page */
+  explicit operator bool() const { return page_ != nullptr; }
+
+  /** @return the page contents, which may change while they are read */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the page contents as a T, which may change while they are read */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(page_->GetData());
+  }
+
+  /** @return true if the guard holds a page that was not written since the guard was taken */
+  bool Validate() const { return page_ != nullptr && page_->ValidateVersion(version_); }
+
+ private:
+  Page *page_{nullptr};
+  uint64_t version_{0};
+};
+
+}  // namespace bustub
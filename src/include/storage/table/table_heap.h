@@ -95,12 +95,18 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param access_type how the page of the tuple is accessed
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type = AccessType::Unknown);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn transaction performing the scan
+   * @param access_type hint for every page fetched by the iterator; AccessType::Scan keeps a full scan from evicting
+   * the rest of the buffer pool
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, AccessType access_type = AccessType::Unknown);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -14,8 +14,10 @@
 
 #include <cassert>
 
+#include "buffer/replacer.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
+#include "storage/page/page_guard.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -24,15 +26,23 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * Between two increments the iterator keeps the page of its tuple pinned (but not latched), so that moving to the next
+ * tuple on the same page does not fetch it again. An iterator that stops short of End holds that pin until it is
+ * destroyed, so it must not outlive its buffer pool. Copies start out without the pin.
  */
 class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, AccessType access_type = AccessType::Unknown);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        access_type_(other.access_type_),
+        pages_visited_(other.pages_visited_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -49,9 +59,12 @@ class TableIterator {
   TableIterator operator++(int);
 
   TableIterator &operator=(const TableIterator &other) {
+    page_guard_.Drop();
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    access_type_ = other.access_type_;
+    pages_visited_ = other.pages_visited_;
     return *this;
   }
 
@@ -59,6 +72,15 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Hint passed to the buffer pool for every page the iterator fetches. */
+  AccessType access_type_;
+  /** Pages moved onto so far; a scan asks for read-ahead every READ_AHEAD_PAGES / 2 pages. */
+  size_t pages_visited_ = 0;
+  /** The page of the current tuple, if the last increment left it pinned. */
+  BasicPageGuard page_guard_;
+
+  /** Ask the buffer pool to read the pages from page_id onwards, if this iterator is a scan. */
+  void ReadAhead(page_id_t page_id);
 };
 
 }  // namespace bustub
@@ -0,0 +1,395 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.cpp
+//
+// Identification: src/storage/disk/async_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BUSTUB_HAVE_IO_URING
+#endif
+
+namespace bustub {
+
+void AsyncIO::Complete(std::unique_ptr<AsyncIORequest> request, int64_t result) {
+  if (result < 0) {
+    LOG_DEBUG("I/O error in asynchronous %s: %s", request->is_write_ ? "write" : "read", strerror(-result));
+    request->done_.set_value(false);
+    return;
+  }
+  const auto transferred = static_cast<size_t>(result);
+  if (transferred < request->size_) {
+    if (request->is_write_) {
+      LOG_DEBUG("I/O error in asynchronous write: wrote less than requested");
+      request->done_.set_value(false);
+      return;
+    }
+    // if file ends before reading the whole buffer
+    memset(request->data_ + transferred, 0, request->size_ - transferred);
+  }
+  if (request->copy_to_ != nullptr) {
+    memcpy(request->copy_to_, request->data_, request->size_);
+  }
+  request->done_.set_value(true);
+}
+
+namespace {
+
+/**
+ * Runs requests with blocking pread/pwrite on a fixed pool of threads.
+ */
+class ThreadPoolAsyncIO : public AsyncIO {
+ public:
+  explicit ThreadPoolAsyncIO(size_t num_threads) {
+    for (size_t i = 0; i < num_threads; ++i) {
+      threads_.emplace_back(&ThreadPoolAsyncIO::Run, this);
+    }
+  }
+
+  ~ThreadPoolAsyncIO() override {
+    {
+      const std::lock_guard<std::mutex> guard(latch_);
+      for (auto &request : queued_) {
+        running_.push_back(std::move(request));
+      }
+      queued_.clear();
+      stopped_ = true;
+    }
+    cv_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Queue(std::unique_ptr<AsyncIORequest> request) override {
+    const std::lock_guard<std::mutex> guard(latch_);
+    queued_.push_back(std::move(request));
+  }
+
+  void Submit() override {
+    {
+      const std::lock_guard<std::mutex> guard(latch_);
+      for (auto &request : queued_) {
+        running_.push_back(std::move(request));
+      }
+      queued_.clear();
+    }
+    cv_.notify_all();
+  }
+
+  bool IsIoUring() const override { return false; }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (true) {
+      cv_.wait(lock, [this] { return stopped_ || !running_.empty(); });
+      // Requests that were submitted before the backend is destroyed still run.
+      if (running_.empty()) {
+        return;
+      }
+      std::unique_ptr<AsyncIORequest> request = std::move(running_.front());
+      running_.pop_front();
+      lock.unlock();
+      const int64_t result = Transfer(request.get());
+      Complete(std::move(request), result);
+      lock.lock();
+    }
+  }
+
+  static int64_t Transfer(AsyncIORequest *request) {
+    size_t done = 0;
+    while (done < request->size_) {
+      ssize_t rc = request->is_write_
+                       ? pwrite(request->fd_, request->data_ + done, request->size_ - done, request->offset_ + done)
+                       : pread(request->fd_, request->data_ + done, request->size_ - done, request->offset_ + done);
+      if (rc < 0 && errno == EINTR) {
+        continue;
+      }
+      if (rc < 0) {
+        return -errno;
+      }
+      if (rc == 0) {
+        break;
+      }
+      done += rc;
+    }
+    return static_cast<int64_t>(done);
+  }
+
+  std::vector<std::thread> threads_;
+  /** Requests waiting for Submit. */
+  std::vector<std::unique_ptr<AsyncIORequest>> queued_;
+  /** Requests waiting for a thread. */
+  std::deque<std::unique_ptr<AsyncIORequest>> running_;
+  bool stopped_ = false;
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+/**
+ * Talks to io_uring through the raw system calls, so that there is no dependency on liburing. Requests are written
+ * into the submission ring by Queue and handed to the kernel by Submit; a reaper thread waits for completions.
+ */
+class IoUringAsyncIO : public AsyncIO {
+ public:
+  /**
+   * Set up a ring with room for queue_depth requests.
+   * @return nullptr if io_uring is not available
+   */
+  static std::unique_ptr<IoUringAsyncIO> Create(size_t queue_depth) {
+    std::unique_ptr<IoUringAsyncIO> io(new IoUringAsyncIO());
+    if (!io->Setup(queue_depth)) {
+      return nullptr;
+    }
+    io->reaper_ = std::thread(&IoUringAsyncIO::Reap, io.get());
+    return io;
+  }
+
+  ~IoUringAsyncIO() override {
+    if (reaper_.joinable()) {
+      // The drain flag holds the no-op back until everything before it completed, so the reaper sees it last.
+      std::unique_lock<std::mutex> lock(latch_);
+      PushSqe(&lock, IORING_OP_NOP, nullptr, IOSQE_IO_DRAIN);
+      SubmitLocked();
+      lock.unlock();
+      reaper_.join();
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+
+  void Queue(std::unique_ptr<AsyncIORequest> request) override {
+    request->iov_.iov_base = request->data_;
+    request->iov_.iov_len = request->size_;
+    const uint8_t opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    std::unique_lock<std::mutex> lock(latch_);
+    PushSqe(&lock, opcode, request.release(), 0);
+  }
+
+  void Submit() override {
+    const std::lock_guard<std::mutex> guard(latch_);
+    SubmitLocked();
+  }
+
+  bool IsIoUring() const override { return true; }
+
+ private:
+  IoUringAsyncIO() = default;
+
+  bool Setup(size_t queue_depth) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+    if (ring_fd_ < 0) {
+      return false;
+    }
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) {
+      return false;
+    }
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(Map(sqes_size_, IORING_OFF_SQES));
+    if (cq_ring_ == nullptr || sqes_ == nullptr) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void *Map(size_t size, off_t offset) {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  int Enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    int rc;
+    do {
+      rc = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0));
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+  }
+
+  /** Hand every request written to the submission ring to the kernel. Must be called with latch_ held. */
+  void SubmitLocked() {
+    while (unsubmitted_ > 0) {
+      const int rc = Enter(unsubmitted_, 0, 0);
+      if (rc < 0 && (errno == EAGAIN || errno == EBUSY)) {
+        // The kernel is short on resources until the reaper consumes some completions.
+        std::this_thread::yield();
+        continue;
+      }
+      if (rc < 0) {
+        LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+        return;
+      }
+      in_flight_ += rc;
+      unsubmitted_ -= rc;
+    }
+  }
+
+  /**
+   * Write a submission queue entry. Waits for completions while the ring already holds sq_entries_ requests, which
+   * also keeps the completion ring (twice as large) from overflowing. Must be called with latch_ held.
+   */
+  void PushSqe(std::unique_lock<std::mutex> *lock, uint8_t opcode, AsyncIORequest *request, uint8_t flags) {
+    if (in_flight_ + unsubmitted_ == sq_entries_) {
+      SubmitLocked();
+    }
+    slot_cv_.wait(*lock, [this] { return in_flight_ + unsubmitted_ < sq_entries_; });
+
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->flags = flags;
+    if (request != nullptr) {
+      sqe->fd = request->fd_;
+      sqe->off = static_cast<uint64_t>(request->offset_);
+      sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+      sqe->len = 1;
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(request);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    unsubmitted_++;
+  }
+
+  void Reap() {
+    std::vector<std::pair<AsyncIORequest *, int64_t>> completed;
+    while (true) {
+      Enter(0, 1, IORING_ENTER_GETEVENTS);
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head) {
+        const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        completed.emplace_back(reinterpret_cast<AsyncIORequest *>(cqe.user_data), cqe.res);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      if (completed.empty()) {
+        continue;
+      }
+      {
+        // Taking the latch also orders the completions after the Queue calls that wrote their requests.
+        const std::lock_guard<std::mutex> guard(latch_);
+        in_flight_ -= completed.size();
+      }
+      slot_cv_.notify_all();
+      bool stop = false;
+      for (auto &[request, result] : completed) {
+        if (request == nullptr) {
+          stop = true;
+        } else {
+          Complete(std::unique_ptr<AsyncIORequest>(request), result);
+        }
+      }
+      completed.clear();
+      if (stop) {
+        return;
+      }
+    }
+  }
+
+  int ring_fd_ = -1;
+  unsigned sq_entries_ = 0;
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned *sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe *cqes_ = nullptr;
+
+  /** Requests written to the submission ring but not yet handed to the kernel. */
+  size_t unsubmitted_ = 0;
+  /** Requests handed to the kernel and not yet reaped. */
+  size_t in_flight_ = 0;
+  /** Protects the submission ring and the two counters above. */
+  std::mutex latch_;
+  /** Signalled when completions free up room in the rings. */
+  std::condition_variable slot_cv_;
+  std::thread reaper_;
+};
+
+#endif
+
+/** Threads of the fallback backend; enough to keep a few dozen blocking reads in flight. */
+constexpr size_t FALLBACK_THREADS = 16;
+
+}  // namespace
+
+std::unique_ptr<AsyncIO> AsyncIO::Create(bool use_io_uring, size_t queue_depth) {
+#ifdef BUSTUB_HAVE_IO_URING
+  if (use_io_uring) {
+    std::unique_ptr<IoUringAsyncIO> io_uring = IoUringAsyncIO::Create(queue_depth);
+    if (io_uring != nullptr) {
+      return io_uring;
+    }
+    LOG_DEBUG("io_uring is not available, falling back to a thread pool");
+  }
+#endif
+  return std::make_unique<ThreadPoolAsyncIO>(FALLBACK_THREADS);
+}
+
+}  // namespace bustub
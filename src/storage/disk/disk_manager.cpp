@@ -10,10 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
@@ -21,17 +30,45 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/lz4_codec.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+
+/** Alignment of buffers, offsets and sizes for O_DIRECT; covers the logical block size of common devices. */
+constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+bool IsAligned(const char *data) { return reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0; }
+
+AlignedBuffer AllocateAligned() {
+  return AlignedBuffer(static_cast<char *>(aligned_alloc(DIRECT_IO_ALIGNMENT, PAGE_SIZE)));
+}
+
+std::future<bool> Completed(bool result) {
+  std::promise<bool> done;
+  done.set_value(result);
+  return done.get_future();
+}
+
+}  // namespace
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, size_t segment_pages)
+    : db_fd_(-1),
+      segment_pages_(segment_pages),
+      db_file_size_(0),
+      file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      num_reads_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -53,78 +90,550 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // Every page id falls into one of the chunks, so the directory never grows.
+  const size_t max_segments = static_cast<size_t>(std::numeric_limits<page_id_t>::max()) / segment_pages_ + 1;
+  num_segment_chunks_ = (max_segments + SEGMENTS_PER_CHUNK - 1) / SEGMENTS_PER_CHUNK;
+  segment_chunks_ = std::make_unique<std::atomic<SegmentChunk *>[]>(num_segment_chunks_);
+  for (size_t i = 0; i < num_segment_chunks_; i++) {
+    segment_chunks_[i] = nullptr;
+  }
+
+  // A new db file is compressed if enable_page_compression is set, an existing one if it has a page mapping table.
+  // Segment 0 stays empty if only pages of later segments were written.
+  const bool new_db_file = GetFileSize(db_file) <= 0 && GetFileSize(GetSegmentName(1)) < 0;
+  const bool compressed =
+      new_db_file ? enable_page_compression.load() : GetFileSize(GetPageMappingTableName()) >= 0;
+  if (compressed) {
+    page_mapping_table_ = std::make_unique<PageMappingTable>(GetPageMappingTableName(), new_db_file);
+  } else if (new_db_file) {
+    std::remove(GetPageMappingTableName().c_str());
+  }
+  if (new_db_file) {
+    std::remove(GetPageChecksumTableName().c_str());
+  } else if (GetFileSize(GetPageChecksumTableName()) >= 0) {
+    checksum_table_ = new PageChecksumTable(GetPageChecksumTableName());
+  }
+
+  // create the file if it does not exist
+  direct_io_ = enable_direct_io && !compressed;
+  db_fd_ = OpenSegmentFile(db_file, true);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  auto *chunk = new SegmentChunk;
+  chunk->segments_[0].fd_ = db_fd_;
+  chunk->segments_[0].preallocated_ = GetFileSize(db_file);
+  segment_chunks_[0] = chunk;
+
+  if (new_db_file) {
+    // a new database: segments and free page maps left behind by an earlier one are stale
+    size_t segment = 1;
+    while (std::remove(GetSegmentName(segment).c_str()) == 0) {
+      segment++;
+    }
+    uint32_t shard = 0;
+    while (std::remove(GetFreePageMapName(shard).c_str()) == 0) {
+      shard++;
+    }
+  } else {
+    // the database ends in its last segment
+    const auto segment_size = static_cast<int64_t>(segment_pages_) * PAGE_SIZE;
+    db_file_size_ = GetFileSize(db_file);
+    for (size_t segment = 1;; segment++) {
+      const int64_t size = GetFileSize(GetSegmentName(segment));
+      if (size < 0) {
+        break;
+      }
+      if (size > 0) {
+        db_file_size_ = static_cast<int64_t>(segment) * segment_size + size;
+      }
     }
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  async_io_.reset();
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+  CloseSegments();
+  for (size_t i = 0; i < num_segment_chunks_; i++) {
+    delete segment_chunks_[i].load();
+  }
+  delete checksum_table_.load();
+}
+
+std::unique_ptr<FreePageMap> DiskManager::OpenFreePageMap(uint32_t shard) {
+  return std::make_unique<FreePageMap>(GetFreePageMapName(shard));
+}
+
+std::string DiskManager::GetFreePageMapName(uint32_t shard) const {
+  return file_name_ + ".fsm." + std::to_string(shard);
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  // wait for outstanding asynchronous I/O before the file goes away
+  async_io_.reset();
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+  CloseSegments();
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    const std::lock_guard<std::mutex> guard(checksum_table_latch_);
+    delete checksum_table_.exchange(nullptr);
   }
   log_io_.close();
 }
 
+void DiskManager::CloseSegments() {
+  if (segment_chunks_ == nullptr) {
+    return;
+  }
+  const std::lock_guard<std::mutex> guard(segment_latch_);
+  for (size_t i = 0; i < num_segment_chunks_; i++) {
+    SegmentChunk *chunk = segment_chunks_[i];
+    if (chunk == nullptr) {
+      continue;
+    }
+    for (auto &segment : chunk->segments_) {
+      const int fd = segment.fd_.exchange(-1);
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+  db_fd_ = -1;
+}
+
+std::string DiskManager::GetSegmentName(size_t segment) const {
+  return segment == 0 ? file_name_ : file_name_ + "." + std::to_string(segment);
+}
+
+int DiskManager::OpenSegmentFile(const std::string &file_name, bool create) {
+  const int flags = O_RDWR | (create ? O_CREAT : 0);
+  int fd = -1;
+  if (direct_io_) {
+    fd = open(file_name.c_str(), flags | O_DIRECT, 0644);
+    if (fd < 0 && errno == EINVAL) {
+      LOG_WARN("the file system does not support O_DIRECT, falling back to buffered I/O");
+      direct_io_ = false;
+    }
+  }
+  if (fd < 0) {
+    fd = open(file_name.c_str(), flags, 0644);
+  }
+  return fd;
+}
+
+DiskManager::Segment *DiskManager::GetSegment(page_id_t page_id, bool create) {
+  if (page_id < 0 || segment_chunks_ == nullptr) {
+    return nullptr;
+  }
+  const size_t index = static_cast<size_t>(page_id) / segment_pages_;
+  SegmentChunk *chunk = segment_chunks_[index / SEGMENTS_PER_CHUNK].load(std::memory_order_acquire);
+  if (chunk != nullptr && chunk->segments_[index % SEGMENTS_PER_CHUNK].fd_.load(std::memory_order_acquire) >= 0) {
+    return &chunk->segments_[index % SEGMENTS_PER_CHUNK];
+  }
+
+  // Slow path, once per segment: open the file, and create the missing segments up to it in order.
+  const std::lock_guard<std::mutex> guard(segment_latch_);
+  if (db_fd_ < 0) {
+    return nullptr;
+  }
+  for (size_t s = create ? 1 : index; s <= index; s++) {
+    auto &slot = segment_chunks_[s / SEGMENTS_PER_CHUNK];
+    if (slot.load(std::memory_order_relaxed) == nullptr) {
+      slot.store(new SegmentChunk, std::memory_order_release);
+    }
+    Segment &segment = slot.load(std::memory_order_relaxed)->segments_[s % SEGMENTS_PER_CHUNK];
+    if (segment.fd_.load(std::memory_order_relaxed) >= 0) {
+      continue;
+    }
+    const int fd = OpenSegmentFile(GetSegmentName(s), create);
+    if (fd < 0) {
+      if (create) {
+        LOG_DEBUG("can't open segment file %zu: %s", s, strerror(errno));
+      }
+      return nullptr;
+    }
+    struct stat stat_buf;
+    segment.preallocated_ = fstat(fd, &stat_buf) == 0 ? stat_buf.st_size : 0;
+    segment.fd_.store(fd, std::memory_order_release);
+  }
+  return &segment_chunks_[index / SEGMENTS_PER_CHUNK].load()->segments_[index % SEGMENTS_PER_CHUNK];
+}
+
+void DiskManager::Preallocate(Segment *segment, int64_t offset) {
+  int64_t preallocated = segment->preallocated_.load(std::memory_order_relaxed);
+  if (offset + PAGE_SIZE <= preallocated || !preallocate_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const int64_t segment_size = static_cast<int64_t>(segment_pages_) * PAGE_SIZE;
+  const int64_t end = std::min(segment_size, offset + static_cast<int64_t>(DB_PREALLOCATE_PAGES) * PAGE_SIZE);
+  // Whoever moves the mark allocates the space; the others write into it before it is allocated, which is harmless.
+  if (!segment->preallocated_.compare_exchange_strong(preallocated, end)) {
+    return;
+  }
+  // A sparse write skips the hole before it; KEEP_SIZE leaves the file size to the writes.
+  const int64_t start = std::max(preallocated, offset);
+  if (fallocate(segment->fd_, FALLOC_FL_KEEP_SIZE, start, end - start) != 0 && errno == EOPNOTSUPP) {
+    preallocate_ = false;
+  }
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+  if (page_mapping_table_ != nullptr) {
+    WriteCompressedPage(page_id, page_data);
+    return;
+  }
+  const auto offset = static_cast<int64_t>(page_id) * PAGE_SIZE;
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  Segment *segment = GetSegment(page_id, true);
+  if (segment == nullptr) {
+    LOG_DEBUG("I/O error writing to a missing segment");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  const int fd = segment->fd_;
+  const int64_t segment_offset = GetSegmentOffset(page_id);
+  Preallocate(segment, segment_offset);
+  AlignedBuffer bounce;
+  if (direct_io_ && !IsAligned(page_data)) {
+    bounce = AllocateAligned();
+    memcpy(bounce.get(), page_data, PAGE_SIZE);
+    page_data = bounce.get();
+  }
+  ssize_t written = 0;
+  bool retried = false;
+  while (written < PAGE_SIZE) {
+    ssize_t rc = pwrite(fd, page_data + written, PAGE_SIZE - written, segment_offset + written);
+    // check for I/O error
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0 && errno == EINVAL && !retried && DisableDirectIO(fd)) {
+      retried = true;
+      continue;
+    }
+    if (rc <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += rc;
+  }
+  // the write went to the kernel directly, so it is visible to every later read without a flush
+  GrowFileSize(offset);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+  if (page_mapping_table_ != nullptr) {
+    ReadCompressedPage(page_id, page_data);
+    return;
+  }
+  const auto offset = static_cast<int64_t>(page_id) * PAGE_SIZE;
+  num_reads_ += 1;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
+    // a page that was allocated but never written reads as zeros, not as whatever the frame held before
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  Segment *segment = GetSegment(page_id, false);
+  if (segment == nullptr) {
+    // a segment past the end, or a hole of segments that were never written
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  const int fd = segment->fd_;
+  const int64_t segment_offset = GetSegmentOffset(page_id);
+  char *data = page_data;
+  AlignedBuffer bounce;
+  if (direct_io_ && !IsAligned(page_data)) {
+    bounce = AllocateAligned();
+    data = bounce.get();
+  }
+  ssize_t read_count = 0;
+  bool retried = false;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(fd, data + read_count, PAGE_SIZE - read_count, segment_offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0 && errno == EINVAL && !retried && DisableDirectIO(fd)) {
+      retried = true;
+      continue;
+    }
+    if (rc < 0) {
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (data != page_data) {
+    memcpy(page_data, data, PAGE_SIZE);
+  }
+}
+
+/**
+ * Queue an asynchronous write of the specified page
+ */
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  if (page_mapping_table_ != nullptr) {
+    return Completed(WriteCompressedPage(page_id, page_data));
+  }
+  Segment *segment = GetSegment(page_id, true);
+  if (segment == nullptr) {
+    num_writes_ += 1;
+    LOG_DEBUG("I/O error writing to a missing segment");
+    return Completed(false);
+  }
+  auto request = std::make_unique<AsyncIORequest>();
+  request->is_write_ = true;
+  request->fd_ = segment->fd_;
+  if (direct_io_ && !IsAligned(page_data)) {
+    request->bounce_ = AllocateAligned();
+    memcpy(request->bounce_.get(), page_data, PAGE_SIZE);
+    request->data_ = request->bounce_.get();
   } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    // the backend only reads from the buffer of a write
+    request->data_ = const_cast<char *>(page_data);
+  }
+  request->size_ = PAGE_SIZE;
+  request->offset_ = GetSegmentOffset(page_id);
+  Preallocate(segment, request->offset_);
+  std::future<bool> done = request->done_.get_future();
+  num_writes_ += 1;
+  // reads of the page are only well-defined after the write completes, so the size can grow right away
+  GrowFileSize(static_cast<int64_t>(page_id) * PAGE_SIZE);
+  GetAsyncIO()->Queue(std::move(request));
+  return done;
+}
+
+/**
+ * Queue an asynchronous read of the specified page
+ */
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  if (page_mapping_table_ != nullptr) {
+    return Completed(ReadCompressedPage(page_id, page_data));
+  }
+  num_reads_ += 1;
+  Segment *segment = GetSegment(page_id, false);
+  if (segment == nullptr) {
+    // like a read past the end of a segment file
+    memset(page_data, 0, PAGE_SIZE);
+    return Completed(page_id >= 0);
+  }
+  auto request = std::make_unique<AsyncIORequest>();
+  request->is_write_ = false;
+  request->fd_ = segment->fd_;
+  if (direct_io_ && !IsAligned(page_data)) {
+    request->bounce_ = AllocateAligned();
+    request->data_ = request->bounce_.get();
+    request->copy_to_ = page_data;
+  } else {
+    request->data_ = page_data;
+  }
+  request->size_ = PAGE_SIZE;
+  request->offset_ = GetSegmentOffset(page_id);
+  std::future<bool> done = request->done_.get_future();
+  GetAsyncIO()->Queue(std::move(request));
+  return done;
+}
+
+bool DiskManager::WriteCompressedPage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  if (page_id < 0) {
+    LOG_DEBUG("I/O error writing an invalid page id");
+    return false;
+  }
+  // Compression has to save at least a sector to be worth decompressing the page on every read.
+  char compressed[PAGE_SIZE];
+  size_t size = Lz4Codec::Compress(page_data, PAGE_SIZE, compressed, PAGE_SIZE - PageMappingTable::SECTOR_SIZE);
+  const bool is_compressed = size != 0;
+  const char *data = is_compressed ? compressed : page_data;
+  if (!is_compressed) {
+    size = PAGE_SIZE;
+  }
+
+  const std::lock_guard<std::mutex> guard(
+      compressed_page_latches_[static_cast<uint32_t>(page_id) % compressed_page_latches_.size()]);
+  const PageMappingTable::Entry entry = page_mapping_table_->Place(page_id, size, is_compressed);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t rc = pwrite(db_fd_, data + written, size - written, entry.offset_ + written);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    written += rc;
+  }
+  // The entry is written after the data, so that it never points to an extent that does not hold the page yet.
+  return page_mapping_table_->Persist(page_id);
+}
+
+bool DiskManager::ReadCompressedPage(page_id_t page_id, char *page_data) {
+  num_reads_ += 1;
+  const std::lock_guard<std::mutex> guard(
+      compressed_page_latches_[static_cast<uint32_t>(page_id) % compressed_page_latches_.size()]);
+  PageMappingTable::Entry entry;
+  if (!page_mapping_table_->Find(page_id, &entry)) {
+    // never written, like a page past the end of an uncompressed file
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  char compressed[PAGE_SIZE];
+  char *data = entry.compressed_ != 0 ? compressed : page_data;
+  size_t read_count = 0;
+  while (read_count < entry.size_) {
+    ssize_t rc = pread(db_fd_, data + read_count, entry.size_ - read_count, entry.offset_ + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
       LOG_DEBUG("I/O error while reading");
+      return false;
+    }
+    read_count += rc;
+  }
+  if (entry.compressed_ != 0 && !Lz4Codec::Decompress(compressed, entry.size_, page_data, PAGE_SIZE)) {
+    LOG_DEBUG("corrupt compressed page");
+    return false;
+  }
+  return true;
+}
+
+PageChecksumTable *DiskManager::GetChecksumTable() {
+  PageChecksumTable *table = checksum_table_.load(std::memory_order_acquire);
+  if (table == nullptr) {
+    const std::lock_guard<std::mutex> guard(checksum_table_latch_);
+    table = checksum_table_.load(std::memory_order_relaxed);
+    if (table == nullptr) {
+      if (db_fd_ < 0) {
+        return nullptr;
+      }
+      table = new PageChecksumTable(GetPageChecksumTableName());
+      checksum_table_.store(table, std::memory_order_release);
+    }
+  }
+  return table;
+}
+
+void DiskManager::MarkChecksumPending(page_id_t page_id) {
+  PageChecksumTable *table = GetChecksumTable();
+  if (table != nullptr) {
+    table->MarkPending(page_id);
+  }
+}
+
+void DiskManager::WriteChecksum(page_id_t page_id, uint32_t checksum) {
+  PageChecksumTable *table = GetChecksumTable();
+  if (table != nullptr) {
+    table->Store(page_id, checksum);
+  }
+}
+
+void DiskManager::ClearChecksum(page_id_t page_id) {
+  // Without a table no page has a checksum, and none is created just to clear one.
+  PageChecksumTable *table = checksum_table_.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    table->Clear(page_id);
+  }
+}
+
+bool DiskManager::ReadChecksum(page_id_t page_id, uint32_t *checksum) {
+  PageChecksumTable *table = checksum_table_.load(std::memory_order_acquire);
+  return table != nullptr && table->Find(page_id, checksum);
+}
+
+bool DiskManager::IsChecksumPending(page_id_t page_id) {
+  PageChecksumTable *table = checksum_table_.load(std::memory_order_acquire);
+  return table != nullptr && table->IsPending(page_id);
+}
+
+const char *DiskManager::MapReadOnly(size_t *size) {
+  std::call_once(mapping_once_, [this] {
+    const auto size = static_cast<size_t>(db_file_size_.load());
+    if (page_mapping_table_ != nullptr || db_fd_ < 0 || size == 0) {
+      return;
+    }
+    // Reserve the address range of the whole database, and map each segment over its part of it. The holes of
+    // segments that are missing or shorter than the reservation read as zeros.
+    void *reservation = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reservation == MAP_FAILED) {
+      LOG_DEBUG("can't map db file: %s", strerror(errno));
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    auto *mapping = static_cast<char *>(reservation);
+    const size_t segment_size = segment_pages_ * PAGE_SIZE;
+    for (size_t offset = 0; offset < size; offset += segment_size) {
+      Segment *segment = GetSegment(static_cast<page_id_t>(offset / PAGE_SIZE), false);
+      struct stat stat_buf;
+      if (segment == nullptr || fstat(segment->fd_, &stat_buf) != 0 || stat_buf.st_size == 0) {
+        continue;
+      }
+      const size_t length = std::min({static_cast<size_t>(stat_buf.st_size), segment_size, size - offset});
+      if (mmap(mapping + offset, length, PROT_READ, MAP_SHARED | MAP_FIXED, segment->fd_, 0) == MAP_FAILED) {
+        LOG_DEBUG("can't map db file: %s", strerror(errno));
+        munmap(mapping, size);
+        return;
+      }
+    }
+    mapping_ = mapping;
+    mapping_size_ = size;
+  });
+  *size = mapping_size_;
+  return mapping_;
+}
+
+void DiskManager::SubmitAsync() { GetAsyncIO()->Submit(); }
+
+bool DiskManager::IsAsyncIoUring() { return GetAsyncIO()->IsIoUring(); }
+
+AsyncIO *DiskManager::GetAsyncIO() {
+  std::call_once(async_io_once_, [this] { async_io_ = AsyncIO::Create(enable_io_uring, ASYNC_IO_QUEUE_DEPTH); });
+  return async_io_.get();
+}
+
+bool DiskManager::DisableDirectIO(int fd) {
+  const int flags = fcntl(fd, F_GETFL);
+  if (flags < 0 || (flags & O_DIRECT) == 0) {
+    // not opened with O_DIRECT, or another thread already switched it off
+    return flags >= 0 && !direct_io_;
+  }
+  // Some file systems accept O_DIRECT on open and only reject the I/O.
+  LOG_WARN("the file system rejected O_DIRECT I/O, falling back to buffered I/O");
+  direct_io_ = false;
+  return fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0;
+}
+
+void DiskManager::GrowFileSize(int64_t offset) {
+  int64_t file_size = db_file_size_;
+  while (file_size < offset + PAGE_SIZE) {
+    if (db_file_size_.compare_exchange_weak(file_size, offset + PAGE_SIZE)) {
+      break;
     }
   }
 }
@@ -201,6 +710,8 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -209,10 +720,10 @@ bool DiskManager::GetFlushState() const { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** "BFPM" */
+constexpr uint32_t FREE_PAGE_MAP_MAGIC = 0x4d504642;
+
+struct FreePageMapHeader {
+  uint32_t magic_;
+  page_id_t reserved_page_id_;
+};
+
+bool WriteFully(int fd, const void *data, size_t size, off_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t rc = pwrite(fd, static_cast<const char *>(data) + written, size - written, offset + written);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      LOG_DEBUG("I/O error while writing free page map");
+      return false;
+    }
+    written += rc;
+  }
+  return true;
+}
+
+}  // namespace
+
+FreePageMap::FreePageMap(const std::string &file_name) {
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open free page map file");
+  }
+  FreePageMapHeader header;
+  if (pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+      header.magic_ != FREE_PAGE_MAP_MAGIC) {
+    // new or unusable: start out empty
+    if (ftruncate(fd_, 0) != 0) {
+      LOG_DEBUG("I/O error while truncating free page map");
+    }
+    WriteHeader();
+    return;
+  }
+  reserved_page_id_ = header.reserved_page_id_;
+
+  struct stat stat_buf;
+  const size_t num_blocks = fstat(fd_, &stat_buf) == 0 && stat_buf.st_size > PAGE_SIZE
+                                ? (stat_buf.st_size - PAGE_SIZE + PAGE_SIZE - 1) / PAGE_SIZE
+                                : 0;
+  words_.resize(num_blocks * WORDS_PER_BLOCK, 0);
+  dirty_blocks_.resize(num_blocks, false);
+  const size_t size = words_.size() * sizeof(uint64_t);
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t rc = pread(fd_, reinterpret_cast<char *>(words_.data()) + read_count, size - read_count,
+                       PAGE_SIZE + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  for (uint64_t word : words_) {
+    num_free_ += __builtin_popcountll(word);
+  }
+}
+
+FreePageMap::~FreePageMap() {
+  Flush();
+  close(fd_);
+}
+
+void FreePageMap::Reserve(page_id_t page_id) {
+  if (page_id >= reserved_page_id_) {
+    reserved_page_id_ = page_id + PAGE_ID_RESERVATION;
+    WriteHeader();
+  }
+}
+
+void FreePageMap::Free(page_id_t page_id) {
+  const auto bit = static_cast<size_t>(page_id);
+  const size_t word = bit / 64;
+  if (word >= words_.size()) {
+    const size_t num_blocks = word / WORDS_PER_BLOCK + 1;
+    words_.resize(num_blocks * WORDS_PER_BLOCK, 0);
+    dirty_blocks_.resize(num_blocks, false);
+  }
+  const uint64_t mask = uint64_t{1} << (bit % 64);
+  if ((words_[word] & mask) != 0) {
+    return;
+  }
+  words_[word] |= mask;
+  dirty_blocks_[word / WORDS_PER_BLOCK] = true;
+  first_free_word_ = std::min(first_free_word_, word);
+  num_free_++;
+}
+
+bool FreePageMap::Reuse(page_id_t *page_id, const std::function<bool(page_id_t)> &usable) {
+  if (num_free_ == 0) {
+    return false;
+  }
+  bool skipped = false;
+  for (size_t word = first_free_word_; word < words_.size(); ++word) {
+    uint64_t bits = words_[word];
+    while (bits != 0) {
+      const int bit = __builtin_ctzll(bits);
+      bits &= bits - 1;
+      const auto candidate = static_cast<page_id_t>(word * 64 + bit);
+      if (!usable(candidate)) {
+        skipped = true;
+        continue;
+      }
+      words_[word] &= ~(uint64_t{1} << bit);
+      num_free_--;
+      WriteBlock(word / WORDS_PER_BLOCK);
+      *page_id = candidate;
+      return true;
+    }
+    if (!skipped) {
+      first_free_word_ = word + 1;
+    }
+  }
+  return false;
+}
+
+void FreePageMap::Flush() {
+  for (size_t block = 0; block < dirty_blocks_.size(); ++block) {
+    if (dirty_blocks_[block]) {
+      WriteBlock(block);
+    }
+  }
+}
+
+void FreePageMap::WriteHeader() {
+  FreePageMapHeader header{FREE_PAGE_MAP_MAGIC, reserved_page_id_};
+  WriteFully(fd_, &header, sizeof(header), 0);
+}
+
+void FreePageMap::WriteBlock(size_t block) {
+  if (WriteFully(fd_, &words_[block * WORDS_PER_BLOCK], PAGE_SIZE, static_cast<off_t>(block + 1) * PAGE_SIZE)) {
+    dirty_blocks_[block] = false;
+  }
+}
+
+}  // namespace bustub
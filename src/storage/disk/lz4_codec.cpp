@@ -0,0 +1,195 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4_codec.cpp
+//
+// Identification: src/storage/disk/lz4_codec.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/lz4_codec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+
+/** Shortest match the format can express. */
+constexpr size_t MIN_MATCH = 4;
+/** The last LAST_LITERALS bytes of the input are always literals. */
+constexpr size_t LAST_LITERALS = 5;
+/** A match must start at least MF_LIMIT bytes before the end of the input. */
+constexpr size_t MF_LIMIT = 12;
+/** Matches reach back at most this far, as offsets are 16 bits. */
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr int HASH_LOG = 12;
+
+uint32_t Read32(const uint8_t *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_LOG); }
+
+/** Append a length that did not fit into its 4 bits of the token. @return false if dst is too small */
+bool WriteLengthExtension(size_t length, uint8_t **op, const uint8_t *oend) {
+  while (length >= 255) {
+    if (*op >= oend) {
+      return false;
+    }
+    *(*op)++ = 255;
+    length -= 255;
+  }
+  if (*op >= oend) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+/** Add the length extension after a token nibble of 15 to length. @return false if src ends first */
+bool ReadLengthExtension(size_t *length, const uint8_t **ip, const uint8_t *iend) {
+  uint8_t byte;
+  do {
+    if (*ip >= iend) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * Append a sequence: the literals from anchor to the match, and then the match, unless match_length is 0.
+ * @return false if dst is too small
+ */
+bool WriteSequence(const uint8_t *anchor, size_t literal_length, size_t offset, size_t match_length, uint8_t **op,
+                   const uint8_t *oend) {
+  if (*op >= oend) {
+    return false;
+  }
+  uint8_t *token = (*op)++;
+  *token = static_cast<uint8_t>((literal_length < 15 ? literal_length : 15) << 4);
+  if (literal_length >= 15 && !WriteLengthExtension(literal_length - 15, op, oend)) {
+    return false;
+  }
+  if (static_cast<size_t>(oend - *op) < literal_length) {
+    return false;
+  }
+  memcpy(*op, anchor, literal_length);
+  *op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+
+  if (oend - *op < 2) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(offset & 0xff);
+  *(*op)++ = static_cast<uint8_t>(offset >> 8);
+  const size_t length = match_length - MIN_MATCH;
+  *token |= static_cast<uint8_t>(length < 15 ? length : 15);
+  return length < 15 || WriteLengthExtension(length - 15, op, oend);
+}
+
+}  // namespace
+
+size_t Lz4Codec::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) {
+  const auto *base = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *iend = base + src_size;
+  const uint8_t *ip = base;
+  const uint8_t *anchor = base;
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *oend = op + dst_capacity;
+
+  if (src_size >= MF_LIMIT + 1) {
+    // Positions are stored plus one, so that 0 means empty.
+    std::vector<uint32_t> table(1 << HASH_LOG, 0);
+    const uint8_t *mf_limit = iend - MF_LIMIT;
+    const uint8_t *match_limit = iend - LAST_LITERALS;
+    while (ip <= mf_limit) {
+      const uint32_t sequence = Read32(ip);
+      const uint32_t hash = Hash(sequence);
+      const uint32_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(ip - base) + 1;
+      if (candidate == 0 || static_cast<size_t>(ip - base) - (candidate - 1) > MAX_DISTANCE ||
+          Read32(base + candidate - 1) != sequence) {
+        ip++;
+        continue;
+      }
+
+      const uint8_t *match = base + candidate - 1;
+      size_t match_length = MIN_MATCH;
+      while (ip + match_length < match_limit && ip[match_length] == match[match_length]) {
+        match_length++;
+      }
+      if (!WriteSequence(anchor, ip - anchor, ip - match, match_length, &op, oend)) {
+        return 0;
+      }
+      ip += match_length;
+      anchor = ip;
+    }
+  }
+
+  if (!WriteSequence(anchor, iend - anchor, 0, 0, &op, oend)) {
+    return 0;
+  }
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+bool Lz4Codec::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *iend = ip + src_size;
+  auto *base = reinterpret_cast<uint8_t *>(dst);
+  uint8_t *op = base;
+  const uint8_t *oend = base + dst_size;
+
+  while (ip < iend) {
+    const uint8_t token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLengthExtension(&literal_length, &ip, iend)) {
+      return false;
+    }
+    if (static_cast<size_t>(iend - ip) < literal_length || static_cast<size_t>(oend - op) < literal_length) {
+      return false;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == iend) {
+      // The last sequence has no match.
+      break;
+    }
+
+    if (iend - ip < 2) {
+      return false;
+    }
+    const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLengthExtension(&match_length, &ip, iend)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - base) || static_cast<size_t>(oend - op) < match_length) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, so it is copied byte by byte.
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < match_length; ++i) {
+      op[i] = match[i];
+    }
+    op += match_length;
+  }
+  return op == oend;
+}
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksum_table.cpp
+//
+// Identification: src/storage/disk/page_checksum_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_checksum_table.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <memory>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+PageChecksumTable::PageChecksumTable(const std::string &file_name) {
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open page checksum table file");
+  }
+  num_chunks_ = static_cast<size_t>(std::numeric_limits<page_id_t>::max()) / PAGES_PER_CHUNK + 1;
+  chunks_ = std::make_unique<std::atomic<std::atomic<uint64_t> *>[]>(num_chunks_);
+  for (size_t i = 0; i < num_chunks_; i++) {
+    chunks_[i] = nullptr;
+  }
+}
+
+PageChecksumTable::~PageChecksumTable() {
+  for (size_t i = 0; i < num_chunks_; i++) {
+    delete[] chunks_[i].load();
+  }
+  close(fd_);
+}
+
+bool PageChecksumTable::Find(page_id_t page_id, uint32_t *checksum) {
+  std::atomic<uint64_t> *entry = GetEntry(page_id);
+  if (entry == nullptr) {
+    return false;
+  }
+  const uint64_t value = entry->load(std::memory_order_relaxed);
+  *checksum = static_cast<uint32_t>(value);
+  return (value & (ENTRY_SET | ENTRY_PENDING)) == ENTRY_SET;
+}
+
+bool PageChecksumTable::IsPending(page_id_t page_id) {
+  std::atomic<uint64_t> *entry = GetEntry(page_id);
+  return entry != nullptr && (entry->load(std::memory_order_relaxed) & ENTRY_PENDING) != 0;
+}
+
+bool PageChecksumTable::MarkPending(page_id_t page_id) { return Write(page_id, ENTRY_PENDING); }
+
+bool PageChecksumTable::Store(page_id_t page_id, uint32_t checksum) { return Write(page_id, ENTRY_SET | checksum); }
+
+bool PageChecksumTable::Clear(page_id_t page_id) { return Write(page_id, 0); }
+
+std::atomic<uint64_t> *PageChecksumTable::GetEntry(page_id_t page_id) {
+  if (page_id < 0) {
+    return nullptr;
+  }
+  const size_t index = static_cast<size_t>(page_id) / PAGES_PER_CHUNK;
+  std::atomic<uint64_t> *chunk = chunks_[index].load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    const std::lock_guard<std::mutex> guard(chunk_latch_);
+    chunk = chunks_[index].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      // The entries past the end of the file, or in holes of it, read as zeros: no checksum.
+      std::unique_ptr<uint64_t[]> entries(new uint64_t[PAGES_PER_CHUNK]());
+      const size_t size = PAGES_PER_CHUNK * sizeof(uint64_t);
+      const auto offset = static_cast<int64_t>(index * size);
+      size_t read_count = 0;
+      while (read_count < size) {
+        ssize_t rc = pread(fd_, reinterpret_cast<char *>(entries.get()) + read_count, size - read_count,
+                           offset + read_count);
+        if (rc < 0 && errno == EINTR) {
+          continue;
+        }
+        if (rc < 0) {
+          // Without its checksums the pages of the chunk are not verified, which beats failing to read them.
+          LOG_DEBUG("I/O error while reading page checksums");
+          std::fill(entries.get(), entries.get() + PAGES_PER_CHUNK, 0);
+          break;
+        }
+        if (rc == 0) {
+          break;
+        }
+        read_count += rc;
+      }
+      chunk = new std::atomic<uint64_t>[PAGES_PER_CHUNK];
+      for (size_t i = 0; i < PAGES_PER_CHUNK; i++) {
+        chunk[i].store(entries[i], std::memory_order_relaxed);
+      }
+      chunks_[index].store(chunk, std::memory_order_release);
+    }
+  }
+  return &chunk[static_cast<size_t>(page_id) % PAGES_PER_CHUNK];
+}
+
+bool PageChecksumTable::Write(page_id_t page_id, uint64_t entry) {
+  std::atomic<uint64_t> *slot = GetEntry(page_id);
+  if (slot == nullptr) {
+    return false;
+  }
+  const std::lock_guard<std::mutex> guard(entry_latches_[static_cast<uint32_t>(page_id) % entry_latches_.size()]);
+  if (slot->load(std::memory_order_relaxed) == entry) {
+    // the same page written again, or one without a checksum cleared again
+    return true;
+  }
+  slot->store(entry, std::memory_order_relaxed);
+  const auto offset = static_cast<int64_t>(page_id) * static_cast<int64_t>(sizeof(uint64_t));
+  ssize_t rc;
+  do {
+    rc = pwrite(fd_, &entry, sizeof(entry), offset);
+  } while (rc < 0 && errno == EINTR);
+  if (rc != static_cast<ssize_t>(sizeof(entry))) {
+    LOG_DEBUG("I/O error while writing a page checksum");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace bustub
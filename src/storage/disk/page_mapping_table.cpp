@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_mapping_table.cpp
+//
+// Identification: src/storage/disk/page_mapping_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_mapping_table.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** "BPMT" */
+constexpr uint32_t PAGE_MAPPING_TABLE_MAGIC = 0x544d5042;
+
+struct PageMappingTableHeader {
+  uint32_t magic_;
+  uint32_t sector_size_;
+  uint64_t reserved_;
+};
+
+static_assert(sizeof(PageMappingTableHeader) == sizeof(PageMappingTable::Entry), "the header takes an entry");
+
+}  // namespace
+
+PageMappingTable::PageMappingTable(const std::string &file_name, bool create) : free_extents_(SECTORS_PER_PAGE + 1) {
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw Exception("can't open page mapping table file");
+  }
+  if (create) {
+    const PageMappingTableHeader header{PAGE_MAPPING_TABLE_MAGIC, SECTOR_SIZE, 0};
+    if (ftruncate(fd_, 0) != 0 || pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+      close(fd_);
+      throw Exception("can't initialize page mapping table file");
+    }
+    return;
+  }
+
+  PageMappingTableHeader header;
+  if (pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+      header.magic_ != PAGE_MAPPING_TABLE_MAGIC || header.sector_size_ != SECTOR_SIZE) {
+    close(fd_);
+    throw Exception("page mapping table file is corrupt");
+  }
+  struct stat stat_buf;
+  const size_t num_entries =
+      fstat(fd_, &stat_buf) == 0 ? (stat_buf.st_size - sizeof(header)) / sizeof(Entry) : 0;
+  entries_.resize(num_entries, Entry{0, 0, 0});
+  const size_t size = num_entries * sizeof(Entry);
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t rc = pread(fd_, reinterpret_cast<char *>(entries_.data()) + read_count, size - read_count,
+                       sizeof(header) + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      close(fd_);
+      throw Exception("can't read page mapping table file");
+    }
+    read_count += rc;
+  }
+
+  // The gaps between the extents in use are free.
+  std::vector<std::pair<uint64_t, size_t>> extents;
+  for (const Entry &entry : entries_) {
+    if (entry.size_ != 0) {
+      extents.emplace_back(entry.offset_, GetNumSectors(entry.size_));
+    }
+  }
+  std::sort(extents.begin(), extents.end());
+  for (const auto &[offset, num_sectors] : extents) {
+    while (data_size_ + SECTOR_SIZE <= offset) {
+      const size_t gap = std::min<uint64_t>((offset - data_size_) / SECTOR_SIZE, SECTORS_PER_PAGE);
+      FreeExtent(data_size_, gap);
+      data_size_ += gap * SECTOR_SIZE;
+    }
+    data_size_ = std::max<uint64_t>(data_size_, offset + num_sectors * SECTOR_SIZE);
+  }
+}
+
+PageMappingTable::~PageMappingTable() { close(fd_); }
+
+bool PageMappingTable::Find(page_id_t page_id, Entry *entry) {
+  const std::lock_guard<std::mutex> guard(latch_);
+  if (page_id < 0 || static_cast<size_t>(page_id) >= entries_.size() || entries_[page_id].size_ == 0) {
+    return false;
+  }
+  *entry = entries_[page_id];
+  return true;
+}
+
+PageMappingTable::Entry PageMappingTable::Place(page_id_t page_id, uint32_t size, bool compressed) {
+  const std::lock_guard<std::mutex> guard(latch_);
+  if (static_cast<size_t>(page_id) >= entries_.size()) {
+    entries_.resize(page_id + 1, Entry{0, 0, 0});
+  }
+  Entry &entry = entries_[page_id];
+  const size_t num_sectors = GetNumSectors(size);
+  if (entry.size_ == 0 || GetNumSectors(entry.size_) != num_sectors) {
+    if (entry.size_ != 0) {
+      // The extent of the persisted entry stays taken until the new entry is persisted. An extent that was placed but
+      // never persisted is not referenced by the file, so it can go right away.
+      if (retiring_extents_.count(page_id) == 0) {
+        retiring_extents_.emplace(page_id, std::make_pair(entry.offset_, GetNumSectors(entry.size_)));
+      } else {
+        FreeExtent(entry.offset_, GetNumSectors(entry.size_));
+      }
+    }
+    entry.offset_ = AllocateExtent(num_sectors);
+  }
+  entry.size_ = size;
+  entry.compressed_ = compressed ? 1 : 0;
+  return entry;
+}
+
+bool PageMappingTable::Persist(page_id_t page_id) {
+  Entry entry;
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    entry = entries_[page_id];
+  }
+  const auto offset = static_cast<off_t>((page_id + 1) * sizeof(Entry));
+  ssize_t rc;
+  do {
+    rc = pwrite(fd_, &entry, sizeof(entry), offset);
+  } while (rc < 0 && errno == EINTR);
+  if (rc != static_cast<ssize_t>(sizeof(entry))) {
+    LOG_DEBUG("I/O error while writing page mapping table");
+    return false;
+  }
+  const std::lock_guard<std::mutex> guard(latch_);
+  auto it = retiring_extents_.find(page_id);
+  if (it != retiring_extents_.end()) {
+    FreeExtent(it->second.first, it->second.second);
+    retiring_extents_.erase(it);
+  }
+  return true;
+}
+
+uint64_t PageMappingTable::GetDataSize() {
+  const std::lock_guard<std::mutex> guard(latch_);
+  return data_size_;
+}
+
+uint64_t PageMappingTable::AllocateExtent(size_t num_sectors) {
+  // The smallest free extent that is large enough, with what is left of it freed again.
+  for (size_t size = num_sectors; size <= SECTORS_PER_PAGE; ++size) {
+    if (!free_extents_[size].empty()) {
+      const uint64_t offset = free_extents_[size].back();
+      free_extents_[size].pop_back();
+      if (size > num_sectors) {
+        FreeExtent(offset + num_sectors * SECTOR_SIZE, size - num_sectors);
+      }
+      return offset;
+    }
+  }
+  const uint64_t offset = data_size_;
+  data_size_ += num_sectors * SECTOR_SIZE;
+  return offset;
+}
+
+void PageMappingTable::FreeExtent(uint64_t offset, size_t num_sectors) { free_extents_[num_sectors].push_back(offset); }
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.cpp
+//
+// Identification: src/storage/page/page_guard.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_guard.h"
+
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace bustub {
+
+BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept
+    : bpm_(that.bpm_), page_(that.page_), is_dirty_(that.is_dirty_) {
+  that.bpm_ = nullptr;
+  that.page_ = nullptr;
+  that.is_dirty_ = false;
+}
+
+BasicPageGuard &BasicPageGuard::operator=(BasicPageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    bpm_ = that.bpm_;
+    page_ = that.page_;
+    is_dirty_ = that.is_dirty_;
+    that.bpm_ = nullptr;
+    that.page_ = nullptr;
+    that.is_dirty_ = false;
+  }
+  return *this;
+}
+
+void BasicPageGuard::Drop() {
+  if (page_ != nullptr) {
+    bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+  }
+  bpm_ = nullptr;
+  page_ = nullptr;
+  is_dirty_ = false;
+}
+
+ReadPageGuard BasicPageGuard::UpgradeRead() {
+  ReadPageGuard guard;
+  if (page_ != nullptr) {
+    page_->RLatch();
+    guard.guard_ = std::move(*this);
+  }
+  return guard;
+}
+
+WritePageGuard BasicPageGuard::UpgradeWrite() {
+  WritePageGuard guard;
+  if (page_ != nullptr) {
+    page_->WLatch();
+    guard.guard_ = std::move(*this);
+  }
+  return guard;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    guard_ = std::move(that.guard_);
+  }
+  return *this;
+}
+
+void ReadPageGuard::Drop() {
+  // The latch goes before the pin: once unpinned, the frame may hold another page.
+  if (guard_.page_ != nullptr) {
+    guard_.page_->RUnlatch();
+  }
+  guard_.Drop();
+}
+
+BasicPageGuard ReadPageGuard::Unlatch() {
+  if (guard_.page_ != nullptr) {
+    guard_.page_->RUnlatch();
+  }
+  return std::move(guard_);
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+  if (this != &that) {
+    Drop();
+    guard_ = std::move(that.guard_);
+  }
+  return *this;
+}
+
+void WritePageGuard::Drop() {
+  if (guard_.page_ != nullptr) {
+    guard_.page_->WUnlatch();
+  }
+  guard_.Drop();
+}
+
+BasicPageGuard WritePageGuard::Unlatch() {
+  if (guard_.page_ != nullptr) {
+    guard_.page_->WUnlatch();
+  }
+  return std::move(guard_);
+}
+
+}  // namespace bustub
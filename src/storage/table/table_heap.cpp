@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <utility>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -28,12 +29,9 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
-  BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
-  first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  first_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  WritePageGuard first_page = buffer_pool_manager_->NewPageGuarded(&first_page_id_).UpgradeWrite();
+  BUSTUB_ASSERT(first_page, "Couldn't create a page for the table heap.");
+  first_page.AsMut<TablePage>()->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
@@ -42,49 +40,39 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  WritePageGuard cur_page = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+  if (!cur_page) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
   // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
+  // Moving on to another page releases the current one, which is only dirtied if a tuple or a next page id was
+  // written to it.
+  while (!cur_page.As<TablePage>()->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    auto next_page_id = cur_page.As<TablePage>()->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
+      // Unlatch and unpin the current page, and repeat the process with the next page.
+      cur_page.Drop();
+      cur_page = buffer_pool_manager_->FetchPageWrite(next_page_id);
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      WritePageGuard new_page = buffer_pool_manager_->NewPageGuarded(&next_page_id).UpgradeWrite();
       // If we could not create a new page,
-      if (new_page == nullptr) {
+      if (!new_page) {
         // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
       // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      cur_page.AsMut<TablePage>()->SetNextPageId(next_page_id);
+      new_page.AsMut<TablePage>()->Init(next_page_id, PAGE_SIZE, cur_page.PageId(), log_manager_, txn);
+      cur_page = std::move(new_page);
     }
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  cur_page.MarkDirty();
+  cur_page.Drop();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
@@ -93,17 +81,15 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  page.AsMut<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  page.Drop();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
@@ -111,18 +97,19 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
-  page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  bool is_updated = page.As<TablePage>()->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    page.MarkDirty();
+  }
+  page.Drop();
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -132,61 +119,47 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(page, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
-  page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  page.AsMut<TablePage>()->ApplyDelete(rid, txn, log_manager_);
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(page, "Couldn't find a page containing that RID.");
   // Rollback the delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  page.AsMut<TablePage>()->RollbackDelete(rid, txn, log_manager_);
 }
 
-bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessType access_type) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  ReadPageGuard page = buffer_pool_manager_->FetchPageRead(rid.GetPageId(), access_type);
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Read the tuple from the page.
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return page.As<TablePage>()->GetTuple(rid, tuple, txn, lock_manager_);
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, AccessType access_type) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
+    ReadPageGuard page = buffer_pool_manager_->FetchPageRead(page_id, access_type);
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    if (found_tuple) {
+    if (page.As<TablePage>()->GetFirstTupleRid(&rid)) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = page.As<TablePage>()->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, access_type);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -16,10 +16,17 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+namespace {
+
+page_id_t NextTablePageId(Page *page) { return static_cast<TablePage *>(page)->GetNextPageId(); }
+
+}  // namespace
+
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, AccessType access_type)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), access_type_(access_type) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    ReadAhead(rid.GetPageId());
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, access_type_);
   }
 }
 
@@ -35,20 +42,24 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  if (page_guard_.PageId() != tuple_->rid_.GetPageId()) {
+    page_guard_ = buffer_pool_manager->FetchPageBasic(tuple_->rid_.GetPageId(), access_type_);
+  }
+  ReadPageGuard cur_page = page_guard_.UpgradeRead();
+  assert(cur_page);  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+  if (!cur_page.As<TablePage>()->GetNextTupleRid(tuple_->rid_,
+                                                 &next_tuple_rid)) {  // end of this page
+    while (cur_page.As<TablePage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      BasicPageGuard next_page =
+          buffer_pool_manager->FetchPageBasic(cur_page.As<TablePage>()->GetNextPageId(), access_type_);
+      cur_page.Drop();
+      if (++pages_visited_ % (READ_AHEAD_PAGES / 2) == 0) {
+        ReadAhead(next_page.PageId());
+      }
+      cur_page = next_page.UpgradeRead();
+      if (cur_page.As<TablePage>()->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
     }
@@ -56,14 +67,20 @@ TableIterator &TableIterator::operator++() {
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    // Read the tuple straight from the latched page rather than fetching it again.
+    cur_page.As<TablePage>()->GetTuple(tuple_->rid_, tuple_, txn_, table_heap_->lock_manager_);
+    // release until copy the tuple, but keep the page pinned for the next increment
+    page_guard_ = cur_page.Unlatch();
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t page_id) {
+  if (access_type_ == AccessType::Scan) {
+    table_heap_->buffer_pool_manager_->ReadAhead(page_id, NextTablePageId, READ_AHEAD_PAGES);
+  }
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -11,9 +11,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -141,4 +146,562 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ClockReplacerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::CLOCK);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: once pages are unpinned, the clock finds them as victims and page 0 survives a round trip to disk.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, LRUKPinnedFrameTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  // Scenario: page 0 stays pinned. It is the replacer's first choice, so every eviction has to get past it.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(2, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(2, true));
+  ASSERT_NE(nullptr, bpm->FetchPage(100));
+  EXPECT_EQ(true, bpm->UnpinPage(100, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  // Scenario: passing over the pinned page did not cost it its history. With two accesses it stays resident, and the
+  // page loaded after its second access goes instead, having only one.
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  const uint64_t misses = bpm->GetStats().misses_;
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(misses, bpm->GetStats().misses_);
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, NeverWrittenPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: pages 1 and 2 are created but never written, so page 2 lies past the end of the file.
+  page_id_t page_id_temp;
+  Page *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  memset(page0->GetData(), 'X', PAGE_SIZE);
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  // Scenario: reading page 2 back into the frame that held page 0 yields zeros, not the bytes of page 0.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  Page *page2 = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page2);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(page2->GetData(), page2->GetData() + PAGE_SIZE));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 50;
+  const int num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write more pages than fit in the pool, so that later fetches have to evict dirty frames.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: concurrent fetchers of overlapping pages must always see the contents that were written, even while
+  // other threads are writing back and reading in frames.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < 500; ++i) {
+        page_id_t page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ScanRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 40;
+  const size_t scan_ring_size = buffer_pool_size / 4;
+  const page_id_t num_hot_pages = 20;
+  const page_id_t num_table_pages = 200;
+
+  for (ReplacerType replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    auto resident = [&](page_id_t first, page_id_t last) {
+      size_t count = 0;
+      for (size_t i = 0; i < buffer_pool_size; ++i) {
+        const page_id_t page_id = bpm->GetPages()[i].GetPageId();
+        count += static_cast<size_t>(page_id >= first && page_id < last);
+      }
+      return count;
+    };
+
+    // Half of the pool holds hot pages, and a table five times the pool size follows them on disk.
+    page_id_t page_id;
+    for (page_id_t i = 0; i < num_hot_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    char data[PAGE_SIZE] = {0};
+    for (page_id_t i = num_hot_pages; i < num_hot_pages + num_table_pages; ++i) {
+      snprintf(data, PAGE_SIZE, "page %d", i);
+      disk_manager->WritePage(i, data);
+    }
+
+    // Scenario: a scan reads the whole table through the ring, so the hot pages stay and the scan only ever occupies
+    // a quarter of the pool.
+    auto scan = [&]() {
+      for (page_id_t i = num_hot_pages; i < num_hot_pages + num_table_pages; ++i) {
+        Page *page = bpm->FetchPage(i, AccessType::Scan);
+        ASSERT_NE(nullptr, page);
+        snprintf(data, PAGE_SIZE, "page %d", i);
+        EXPECT_EQ(0, strcmp(page->GetData(), data));
+        ASSERT_TRUE(bpm->UnpinPage(i, false));
+      }
+    };
+    scan();
+    EXPECT_EQ(num_hot_pages, resident(0, num_hot_pages));
+    EXPECT_EQ(scan_ring_size, resident(num_hot_pages, num_hot_pages + num_table_pages));
+
+    // Scenario: a ring page fetched without the hint leaves the ring and survives the next scan.
+    const page_id_t last_page_id = num_hot_pages + num_table_pages - 1;
+    ASSERT_NE(nullptr, bpm->FetchPage(last_page_id));
+    ASSERT_TRUE(bpm->UnpinPage(last_page_id, false));
+    scan();
+    EXPECT_EQ(num_hot_pages, resident(0, num_hot_pages));
+    EXPECT_EQ(1, resident(last_page_id, last_page_id + 1));
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const double saved_clean_target = bg_writer_clean_target;
+  bg_writer_clean_target = 0.5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+
+  // Scenario: pinned pages are never written, and once unpinned, pages are written until half of the pool is clean.
+  EXPECT_EQ(0U, bpm->BackgroundWriterRound());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    ASSERT_TRUE(bpm->UnpinPage(i, true));
+  }
+  EXPECT_EQ(buffer_pool_size / 2, bpm->BackgroundWriterRound());
+  EXPECT_EQ(static_cast<int>(buffer_pool_size / 2), disk_manager->GetNumWrites());
+  EXPECT_EQ(0U, bpm->BackgroundWriterRound());
+
+  // Scenario: with logging enabled, a page is only written once its LSN is persistent.
+  bg_writer_clean_target = 1.0;
+  enable_logging = true;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(i);
+    ASSERT_TRUE(bpm->UnpinPage(i, true));
+  }
+  log_manager->SetPersistentLSN(3);
+  EXPECT_EQ(4U, bpm->BackgroundWriterRound());
+  log_manager->SetPersistentLSN(static_cast<lsn_t>(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size - 4, bpm->BackgroundWriterRound());
+  enable_logging = false;
+
+  // Scenario: the background thread cleans dirty pages on its own, so eviction finds clean victims.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    ASSERT_TRUE(bpm->UnpinPage(i, true));
+  }
+  bpm->RunBackgroundWriter();
+  Page *pages = bpm->GetPages();
+  for (int wait = 0; wait < 500; ++wait) {
+    bool all_clean = true;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      all_clean = all_clean && !pages[i].IsDirty();
+    }
+    if (all_clean) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundWriter();
+  const int writes = disk_manager->GetNumWrites();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(writes, disk_manager->GetNumWrites());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page->GetLSN());
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+  bg_writer_clean_target = saved_clean_target;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentWriteBackTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const double saved_clean_target = bg_writer_clean_target;
+  bg_writer_clean_target = 1.0;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: the page is changed and flushed while the background writer and FlushAllPages write it too. Whatever
+  // the order of the writes, the last version ends up on disk once the page is clean.
+  const int num_versions = 10000;
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    while (!done) {
+      bpm->BackgroundWriterRound();
+      bpm->FlushAllPages();
+    }
+  });
+  for (int version = 1; version <= num_versions; ++version) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page->WLatch();
+    memcpy(page->GetData(), &version, sizeof(version));
+    page->WUnlatch();
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    if (version % 8 == 0) {
+      ASSERT_TRUE(bpm->FlushPage(page_id));
+    }
+  }
+  done = true;
+  writer.join();
+  bpm->FlushAllPages();
+
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(page_id, data);
+  int version;
+  memcpy(&version, data, sizeof(version));
+  EXPECT_EQ(num_versions, version);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+  bg_writer_clean_target = saved_clean_target;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReadAheadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 40;
+  const page_id_t num_pages = 100;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // A chain of pages on disk, each holding the id of the next one in its first bytes.
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    const page_id_t next_page_id = i + 1 < num_pages ? i + 1 : INVALID_PAGE_ID;
+    memcpy(data, &next_page_id, sizeof(page_id_t));
+    disk_manager->WritePage(i, data);
+  }
+  auto next_page = [](Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); };
+  auto wait_for_resident = [&](page_id_t first, page_id_t last) {
+    size_t count = 0;
+    for (int wait = 0; wait < 500; ++wait) {
+      count = 0;
+      for (size_t i = 0; i < buffer_pool_size; ++i) {
+        const page_id_t page_id = bpm->GetPages()[i].GetPageId();
+        count += static_cast<size_t>(page_id >= first && page_id < last);
+      }
+      if (count == static_cast<size_t>(last - first)) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return count;
+  };
+
+  // Scenario: read-ahead follows the chain in the background and leaves the pages unpinned.
+  bpm->ReadAhead(0, next_page, READ_AHEAD_PAGES);
+  EXPECT_EQ(static_cast<size_t>(READ_AHEAD_PAGES), wait_for_resident(0, READ_AHEAD_PAGES));
+  for (page_id_t i = 0; i < READ_AHEAD_PAGES; ++i) {
+    Page *page = bpm->FetchPage(i, AccessType::Scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(i + 1, next_page(page));
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: read-ahead stops at the end of the chain.
+  bpm->ReadAhead(num_pages - 3, next_page, READ_AHEAD_PAGES);
+  EXPECT_EQ(3U, wait_for_resident(num_pages - 3, num_pages));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReuseDeletedPageIdsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  remove(db_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(i, page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // A pinned page cannot be deleted, and its id is not freed.
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_FALSE(bpm->DeletePage(3));
+  ASSERT_TRUE(bpm->UnpinPage(3, false));
+
+  // Deleted ids are handed out again, lowest first.
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_TRUE(bpm->DeletePage(1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Ids that were never handed out are not freed.
+  EXPECT_TRUE(bpm->DeletePage(100));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(3, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(5, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // After a restart, deleted ids are still reused and new ids do not go back.
+  EXPECT_TRUE(bpm->DeletePage(2));
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_GT(page_id, 5);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove((db_name + ".fsm.0").c_str());
+
+  // A reused id starts out zeroed even if the caller leaves it clean and it is evicted before the next fetch.
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(1, disk_manager);
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  ASSERT_EQ(0, page_id);
+  snprintf(page->GetData(), PAGE_SIZE, "OLD CONTENTS");
+  ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  ASSERT_TRUE(bpm->FlushPage(page_id));
+  ASSERT_TRUE(bpm->DeletePage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_EQ(0, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetData()[0]);
+  ASSERT_TRUE(bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove((db_name + ".fsm.0").c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  remove(db_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  // Pages 0 to 9 are written back and evicted by pages 10 to 19, which are left dirty in the pool.
+  for (page_id_t i = 0; i < 20; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // A resident page, misses that evict dirty pages, and a page that appears twice.
+  ASSERT_NE(nullptr, bpm->FetchPage(15));
+  const std::vector<page_id_t> page_ids = {0, 15, 3, 3, 7};
+  std::vector<Page *> pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < pages.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[2], pages[3]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  EXPECT_EQ(2, pages[2]->GetPinCount());
+  for (page_id_t id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(15, false));
+  EXPECT_FALSE(bpm->UnpinPage(3, false));
+
+  // The dirty pages that were evicted by the batch were written back first.
+  pages = bpm->FetchPages({10, 11, 12});
+  for (size_t i = 0; i < pages.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("page " + std::to_string(10 + i), std::string(pages[i]->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(10 + i, false));
+  }
+
+  // With more pages than frames, the pages that do not fit are nullptr.
+  std::vector<page_id_t> too_many;
+  for (page_id_t i = 0; i < 12; ++i) {
+    too_many.push_back(i);
+  }
+  pages = bpm->FetchPages(too_many);
+  EXPECT_EQ(buffer_pool_size, pages.size() - std::count(pages.begin(), pages.end(), nullptr));
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove((db_name + ".fsm.0").c_str());
+}
+
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, AlignmentTest) {
+  // Scenario: small and huge-page-sized arenas hand out zeroed, page-aligned, non-overlapping frames.
+  for (size_t num_frames : {1, 10, 512, 1000}) {
+    FrameArena arena(num_frames);
+    if (num_frames < 512) {
+      EXPECT_EQ(FrameArena::Backing::PAGES, arena.GetBacking());
+    }
+    for (size_t i = 0; i < num_frames; ++i) {
+      char *frame = arena.GetFrame(static_cast<frame_id_t>(i));
+      EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(frame) % PAGE_SIZE);
+      EXPECT_EQ(0, frame[0]);
+      EXPECT_EQ(0, frame[PAGE_SIZE - 1]);
+      frame[0] = static_cast<char>(i);
+      frame[PAGE_SIZE - 1] = static_cast<char>(i);
+    }
+    for (size_t i = 0; i < num_frames; ++i) {
+      EXPECT_EQ(static_cast<char>(i), arena.GetFrame(static_cast<frame_id_t>(i))[0]);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolFramesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: page data is page-aligned, and the descriptors sit on cache lines of their own.
+  EXPECT_EQ(0U, sizeof(Page) % CACHE_LINE_SIZE);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(page) % CACHE_LINE_SIZE);
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
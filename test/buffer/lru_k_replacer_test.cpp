@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Replays a page reference string against a replacer the way a buffer pool would and counts hits.
+ */
+class ReplacerSimulator {
+ public:
+  ReplacerSimulator(Replacer *replacer, size_t num_frames) : replacer_(replacer), frames_(num_frames) {
+    for (size_t i = 0; i < num_frames; ++i) {
+      free_frames_.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  void Access(page_id_t page_id) {
+    accesses_++;
+    frame_id_t frame_id;
+    auto iter = page_to_frame_.find(page_id);
+    if (iter != page_to_frame_.end()) {
+      hits_++;
+      frame_id = iter->second;
+      replacer_->Pin(frame_id);
+    } else if (!free_frames_.empty()) {
+      frame_id = free_frames_.back();
+      free_frames_.pop_back();
+    } else {
+      ASSERT_TRUE(replacer_->Victim(&frame_id));
+      replacer_->Remove(frame_id);
+      page_to_frame_.erase(frames_[frame_id]);
+    }
+    frames_[frame_id] = page_id;
+    page_to_frame_[page_id] = frame_id;
+    replacer_->RecordAccess(frame_id, AccessType::Unknown);
+    replacer_->Unpin(frame_id);
+  }
+
+  double HitRatio() const { return static_cast<double>(hits_) / static_cast<double>(accesses_); }
+
+ private:
+  Replacer *replacer_;
+  std::vector<page_id_t> frames_;
+  std::vector<frame_id_t> free_frames_;
+  std::unordered_map<page_id_t, frame_id_t> page_to_frame_;
+  size_t accesses_{0};
+  size_t hits_{0};
+};
+
+/**
+ * A looping probe over a small index working set, alternating with a sequential scan over a table much larger than
+ * the pool. Every scan touches more pages than the pool has frames.
+ */
+double RunIndexProbeWithScan(Replacer *replacer, size_t num_frames) {
+  const page_id_t num_index_pages = 8;
+  const page_id_t num_table_pages = 1000;
+  const page_id_t table_start = 1000;
+  const page_id_t scan_length = 64;
+
+  ReplacerSimulator simulator(replacer, num_frames);
+  page_id_t next_table_page = 0;
+  for (int round = 0; round < 100; ++round) {
+    for (int probe = 0; probe < 3; ++probe) {
+      for (page_id_t index_page = 0; index_page < num_index_pages; ++index_page) {
+        simulator.Access(index_page);
+      }
+    }
+    for (page_id_t i = 0; i < scan_length; ++i) {
+      simulator.Access(table_start + next_table_page);
+      next_table_page = (next_table_page + 1) % num_table_pages;
+    }
+  }
+  return simulator.HitRatio();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1 to 5 are accessed once, frame 6 twice. All six are evictable.
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_k_replacer.RecordAccess(frame_id, AccessType::Unknown);
+    lru_k_replacer.Unpin(frame_id);
+  }
+  lru_k_replacer.RecordAccess(6, AccessType::Unknown);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frame 1 gets a second access, so it is no longer at infinite distance.
+  lru_k_replacer.RecordAccess(1, AccessType::Unknown);
+
+  // Scenario: frames with a single access go first, in the order of their access.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+
+  // Scenario: pinned frames are skipped.
+  lru_k_replacer.Pin(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+
+  // Scenario: among frames with K accesses, the one with the oldest second most recent access goes first. That is
+  // frame 1, even though its most recent access is the latest of all.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: a victim that is put back keeps its history, while a removed frame starts over with none. Frame 1 has
+  // a single access after its removal, so it goes before frame 6 but after frame 4, whose only access is older.
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Remove(1);
+  lru_k_replacer.RecordAccess(1, AccessType::Unknown);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t num_frames = 16;
+  auto lru_replacer = std::make_unique<LRUReplacer>(num_frames);
+  auto clock_replacer = std::make_unique<ClockReplacer>(num_frames);
+  auto lru_k_replacer = std::make_unique<LRUKReplacer>(num_frames, 2);
+
+  double lru_hit_ratio = RunIndexProbeWithScan(lru_replacer.get(), num_frames);
+  double clock_hit_ratio = RunIndexProbeWithScan(clock_replacer.get(), num_frames);
+  double lru_k_hit_ratio = RunIndexProbeWithScan(lru_k_replacer.get(), num_frames);
+
+  // Every scan flushes the index pages out of LRU and CLOCK, so the first probe of each round misses. LRU-2 only
+  // evicts pages the scan touched once, so every index probe after the first round hits.
+  const double index_share = 24.0 / (24.0 + 64.0);
+  EXPECT_LT(lru_hit_ratio, index_share * 0.7);
+  EXPECT_GT(lru_k_hit_ratio, index_share * 0.95);
+  EXPECT_GT(lru_k_hit_ratio, clock_hit_ratio);
+}
+
+}  // namespace bustub
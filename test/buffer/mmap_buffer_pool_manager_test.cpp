@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, ReadOnlyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 50;
+  remove(db_name.c_str());
+
+  // Write the snapshot through a regular buffer pool.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name);
+  auto *mmap_bpm = new MmapBufferPoolManager(disk_manager);
+  EXPECT_EQ(num_pages, mmap_bpm->GetPoolSize());
+
+  // Every page can be fetched at once, as there are no frames to run out of, and a page is always the same view.
+  std::vector<Page *> pages;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    Page *page = mmap_bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page->GetPageId());
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    pages.push_back(page);
+  }
+  EXPECT_EQ(pages[7], mmap_bpm->FetchPage(7));
+  EXPECT_EQ(2, pages[7]->GetPinCount());
+  EXPECT_TRUE(mmap_bpm->UnpinPage(7, false));
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    EXPECT_TRUE(mmap_bpm->UnpinPage(i, false));
+  }
+  EXPECT_FALSE(mmap_bpm->UnpinPage(7, false));
+
+  // Pages past the end of the file do not exist, and nothing can be written.
+  EXPECT_EQ(nullptr, mmap_bpm->FetchPage(num_pages));
+  EXPECT_EQ(nullptr, mmap_bpm->FetchPage(INVALID_PAGE_ID));
+  EXPECT_EQ(nullptr, mmap_bpm->NewPage(&page_id));
+  EXPECT_FALSE(mmap_bpm->DeletePage(3));
+  ASSERT_NE(nullptr, mmap_bpm->FetchPage(3));
+  EXPECT_FALSE(mmap_bpm->UnpinPage(3, true));
+  // The refused unpin left the page pinned.
+  EXPECT_EQ(2, mmap_bpm->FetchPage(3)->GetPinCount());
+  EXPECT_TRUE(mmap_bpm->UnpinPage(3, false));
+  EXPECT_TRUE(mmap_bpm->UnpinPage(3, false));
+  EXPECT_FALSE(mmap_bpm->UnpinPage(3, false));
+
+  // Guards and optimistic reads work as with any buffer pool, from many threads at once.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([mmap_bpm, num_pages] {
+      for (page_id_t i = 0; i < num_pages; ++i) {
+        ReadPageGuard guard = mmap_bpm->FetchPageRead(i);
+        ASSERT_TRUE(guard);
+        EXPECT_EQ("page " + std::to_string(i), std::string(guard.GetData()));
+        OptimisticPageGuard optimistic = mmap_bpm->FetchPageOptimistic(i);
+        ASSERT_TRUE(optimistic);
+        EXPECT_EQ(guard.GetData(), optimistic.GetData());
+        EXPECT_TRUE(optimistic.Validate());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete mmap_bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // An empty file cannot be mapped.
+  remove(db_name.c_str());
+  disk_manager = new DiskManager(db_name);
+  EXPECT_THROW(MmapBufferPoolManager{disk_manager}, Exception);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove((db_name + ".fsm.0").c_str());
+}
+
+}  // namespace bustub
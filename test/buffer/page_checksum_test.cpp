@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksum_test.cpp
+//
+// Identification: test/buffer/page_checksum_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/crc32c.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class PageChecksumTest : public ::testing::Test {
+ protected:
+  void SetUp() override { RemoveFiles(); }
+
+  void TearDown() override { RemoveFiles(); }
+
+  static void RemoveFiles() {
+    for (const char *suffix : {"", ".crc", ".fsm.0", ".fsm.1", ".fsm.2", ".fsm.3"}) {
+      remove((db_name + suffix).c_str());
+    }
+    remove("test_checksum.log");
+  }
+
+  static const std::string db_name;
+};
+
+const std::string PageChecksumTest::db_name = "test_checksum.db";  // NOLINT
+
+// NOLINTNEXTLINE
+TEST_F(PageChecksumTest, DiskManagerTest) {
+  {
+    DiskManager dm(db_name);
+    uint32_t checksum;
+    EXPECT_FALSE(dm.ReadChecksum(0, &checksum));
+    // Clearing a checksum does not create the table.
+    dm.ClearChecksum(0);
+    EXPECT_FALSE(std::ifstream(db_name + ".crc").good());
+
+    dm.WriteChecksum(0, 0);
+    dm.WriteChecksum(7, 0xdeadbeef);
+    dm.WriteChecksum(100000, 42);
+    dm.WriteChecksum(8, 1);
+    dm.ClearChecksum(8);
+    // A pending write hides the previous checksum until the new one is stored.
+    dm.MarkChecksumPending(9);
+    dm.WriteChecksum(10, 10);
+    dm.MarkChecksumPending(10);
+    EXPECT_FALSE(dm.ReadChecksum(10, &checksum));
+    EXPECT_TRUE(dm.IsChecksumPending(10));
+    dm.WriteChecksum(10, 11);
+    EXPECT_FALSE(dm.IsChecksumPending(10));
+    EXPECT_TRUE(dm.ReadChecksum(10, &checksum));
+    EXPECT_EQ(11U, checksum);
+    EXPECT_TRUE(dm.ReadChecksum(0, &checksum));
+    EXPECT_EQ(0U, checksum);
+    EXPECT_TRUE(dm.ReadChecksum(7, &checksum));
+    EXPECT_EQ(0xdeadbeefU, checksum);
+    EXPECT_FALSE(dm.ReadChecksum(8, &checksum));
+    EXPECT_FALSE(dm.ReadChecksum(-1, &checksum));
+    char data[PAGE_SIZE] = {0};
+    dm.WritePage(0, data);
+    dm.ShutDown();
+  }
+
+  // The checksums of an existing database are read back from the table.
+  DiskManager dm(db_name);
+  uint32_t checksum;
+  EXPECT_TRUE(dm.ReadChecksum(7, &checksum));
+  EXPECT_EQ(0xdeadbeefU, checksum);
+  EXPECT_TRUE(dm.ReadChecksum(100000, &checksum));
+  EXPECT_EQ(42U, checksum);
+  EXPECT_FALSE(dm.ReadChecksum(8, &checksum));
+  EXPECT_FALSE(dm.IsChecksumPending(8));
+  EXPECT_FALSE(dm.ReadChecksum(9, &checksum));
+  EXPECT_TRUE(dm.IsChecksumPending(9));
+  EXPECT_FALSE(dm.ReadChecksum(11, &checksum));
+  EXPECT_FALSE(dm.IsChecksumPending(11));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PageChecksumTest, TornPageTest) {
+  const size_t num_pages = 8;
+  DiskManager dm(db_name);
+  std::vector<page_id_t> page_ids;
+  {
+    BufferPoolManagerInstance bpm(num_pages, &dm);
+    bpm.SetPageChecksums(true);
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      Page *page = bpm.NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      page_ids.push_back(page_id);
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.FlushAllPages();
+    EXPECT_EQ(num_pages, bpm.GetStats().checksums_written_);
+  }
+  uint32_t checksum;
+  ASSERT_TRUE(dm.ReadChecksum(page_ids[0], &checksum));
+  char data[PAGE_SIZE];
+  dm.ReadPage(page_ids[0], data);
+  EXPECT_EQ(Crc32c::Compute(data, PAGE_SIZE), checksum);
+
+  // Half of page 1 and page 3 make it to disk, as if their writes were torn.
+  for (page_id_t page_id : {page_ids[1], page_ids[3]}) {
+    dm.ReadPage(page_id, data);
+    memset(data + PAGE_SIZE / 2, 0x5a, PAGE_SIZE / 2);
+    dm.WritePage(page_id, data);
+  }
+
+  BufferPoolManagerInstance bpm(num_pages, &dm);
+  bpm.SetPageChecksums(true);
+  // The fetch of a torn page fails with an error of its own, and its frame goes back to the pool.
+  try {
+    bpm.FetchPage(page_ids[1]);
+    ADD_FAILURE() << "a torn page was handed out";
+  } catch (const Exception &e) {
+    EXPECT_EQ(ExceptionType::CORRUPT_PAGE, e.GetType());
+  }
+  Page *page = bpm.FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("page 0", page->GetData());
+  bpm.UnpinPage(page_ids[0], false);
+  // The same through a batched fetch, which leaves the other pages of the batch unpinned.
+  EXPECT_THROW(bpm.FetchPages({page_ids[2], page_ids[3], page_ids[4]}), Exception);
+
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(5U, stats.checksums_verified_);
+  EXPECT_EQ(2U, stats.checksum_failures_);
+  EXPECT_EQ(num_pages, stats.free_frames_ + stats.evictable_frames_);
+
+  // Without checksums the torn page is handed out. Written back, it has no checksum any more.
+  bpm.SetPageChecksums(false);
+  page = bpm.FetchPage(page_ids[1]);
+  ASSERT_NE(nullptr, page);
+  bpm.UnpinPage(page_ids[1], true);
+  bpm.FlushPage(page_ids[1]);
+  EXPECT_FALSE(dm.ReadChecksum(page_ids[1], &checksum));
+  bpm.SetPageChecksums(true);
+  page = bpm.FetchPage(page_ids[1]);
+  EXPECT_NE(nullptr, page);
+  bpm.UnpinPage(page_ids[1], false);
+
+  // A deleted page takes its checksum with it, so that its id can be reused.
+  ASSERT_TRUE(bpm.DeletePage(page_ids[5]));
+  EXPECT_FALSE(dm.ReadChecksum(page_ids[5], &checksum));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PageChecksumTest, UnfinishedWriteTest) {
+  DiskManager dm(db_name);
+  page_id_t page_id;
+  {
+    BufferPoolManagerInstance bpm(4, &dm);
+    bpm.SetPageChecksums(true);
+    Page *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "before the crash");
+    bpm.UnpinPage(page_id, true);
+    bpm.FlushPage(page_id);
+  }
+
+  // A write of the page goes out, but the process stops before its checksum is stored. Half of the page made it.
+  dm.MarkChecksumPending(page_id);
+  char data[PAGE_SIZE];
+  dm.ReadPage(page_id, data);
+  memset(data + PAGE_SIZE / 2, 0x5a, PAGE_SIZE / 2);
+  dm.WritePage(page_id, data);
+
+  // The page is handed out for redo rather than reported as corrupt.
+  BufferPoolManagerInstance bpm(4, &dm);
+  bpm.SetPageChecksums(true);
+  Page *page = bpm.FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(1U, stats.checksums_pending_);
+  EXPECT_EQ(0U, stats.checksum_failures_);
+
+  // Once redone and written back, it has a checksum again.
+  memset(page->GetData() + PAGE_SIZE / 2, 0, PAGE_SIZE / 2);
+  bpm.UnpinPage(page_id, true);
+  bpm.FlushPage(page_id);
+  EXPECT_FALSE(dm.IsChecksumPending(page_id));
+  uint32_t checksum;
+  ASSERT_TRUE(dm.ReadChecksum(page_id, &checksum));
+  dm.ReadPage(page_id, data);
+  EXPECT_EQ(Crc32c::Compute(data, PAGE_SIZE), checksum);
+  EXPECT_STREQ("before the crash", data);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PageChecksumTest, ParallelTest) {
+  DiskManager dm(db_name);
+  ParallelBufferPoolManager bpm(2, 4, &dm);
+  bpm.SetPageChecksums(true);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 16; ++i) {
+    page_id_t page_id;
+    Page *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    page->GetData()[0] = static_cast<char>(i);
+    page_ids.push_back(page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+  // Instances added by a resize checksum pages as well.
+  ASSERT_TRUE(bpm.Resize(4));
+  for (int i = 0; i < 16; ++i) {
+    Page *page = bpm.FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<char>(i), page->GetData()[0]);
+    page->GetData()[1] = 1;
+    bpm.UnpinPage(page_ids[i], true);
+  }
+  bpm.FlushAllPages();
+  for (page_id_t page_id : page_ids) {
+    uint32_t checksum;
+    EXPECT_TRUE(dm.ReadChecksum(page_id, &checksum));
+  }
+  const BufferPoolStats stats = bpm.GetStats();
+  EXPECT_GT(stats.checksums_written_, 0U);
+  EXPECT_GT(stats.checksums_verified_, 0U);
+  EXPECT_EQ(0U, stats.checksum_failures_);
+  dm.ShutDown();
+}
+
+}  // namespace bustub
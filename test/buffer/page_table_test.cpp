@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+
+  // Scenario: insert strided page ids, as a parallel buffer pool instance would hand them out.
+  for (int i = 0; i < 8; ++i) {
+    page_table.Insert(i * 5, i);
+  }
+  EXPECT_EQ(8, page_table.Size());
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(page_table.Find(i * 5, &frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  // Scenario: remapping a page keeps a single entry.
+  page_table.Insert(10, 7);
+  EXPECT_EQ(8, page_table.Size());
+  ASSERT_TRUE(page_table.Find(10, &frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  // Scenario: removing every other page leaves the rest reachable.
+  for (int i = 0; i < 8; i += 2) {
+    EXPECT_TRUE(page_table.Remove(i * 5));
+  }
+  EXPECT_FALSE(page_table.Remove(0));
+  EXPECT_EQ(4, page_table.Size());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i % 2 == 1, page_table.Find(i * 5, &frame_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentReadTest) {
+  const int num_pages = 64;
+  PageTable page_table(num_pages);
+  // Pages [0, num_pages / 2) stay in the table for the whole test; the rest churn.
+  for (int i = 0; i < num_pages / 2; ++i) {
+    page_table.Insert(i, i);
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&page_table, &done] {
+      frame_id_t frame_id;
+      while (!done) {
+        for (int i = 0; i < num_pages; ++i) {
+          // A lock-free lookup may miss, but must never return another page's frame.
+          if (page_table.Find(i, &frame_id)) {
+            EXPECT_EQ(i, frame_id);
+          }
+        }
+      }
+    });
+  }
+
+  for (int round = 0; round < 1000; ++round) {
+    for (int i = num_pages / 2; i < num_pages; ++i) {
+      page_table.Insert(i, i);
+    }
+    for (int i = num_pages / 2; i < num_pages; ++i) {
+      page_table.Remove(i);
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  frame_id_t frame_id;
+  for (int i = 0; i < num_pages / 2; ++i) {
+    ASSERT_TRUE(page_table.Find(i, &frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+  EXPECT_EQ(num_pages / 2, page_table.Size());
+}
+
+}  // namespace bustub
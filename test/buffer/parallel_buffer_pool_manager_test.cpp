@@ -11,9 +11,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -154,4 +159,340 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 100;
+  const size_t num_instances = 4;
+  const auto num_pages = static_cast<page_id_t>(buffer_pool_size * num_instances);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, page_id_temp % 2 == 1));
+  }
+  // Page 1 stays pinned while it is flushed.
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+
+  // Scenario: only the dirty pages are written, pinned or not.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages / 2, disk_manager->GetNumWrites());
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (page_id_t i = 1; i < num_pages; i += 2) {
+    disk_manager->ReadPage(i, data);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+
+  // Scenario: after a flush every page is clean, so flushing again writes nothing.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages / 2, disk_manager->GetNumWrites());
+  EXPECT_TRUE(bpm->UnpinPage(1, true));
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages / 2 + 1, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+
+  // Fill both instances with dirty pages.
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  auto check_pages = [&] {
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id : page_ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  };
+
+  // Scenario: growing adds frames, moved pages keep their contents, and new page ids do not collide with old ones.
+  EXPECT_TRUE(bpm->Resize(4));
+  EXPECT_EQ(4U, bpm->GetNumInstances());
+  EXPECT_EQ(4 * buffer_pool_size, bpm->GetPoolSize());
+  check_pages();
+  std::vector<page_id_t> new_page_ids;
+  for (size_t i = 0; i < 4 * buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), page_id_temp));
+    EXPECT_EQ(new_page_ids.end(), std::find(new_page_ids.begin(), new_page_ids.end(), page_id_temp));
+    new_page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (page_id_t page_id : new_page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a pinned page keeps its instance from being retired until it is unpinned.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+  EXPECT_FALSE(bpm->Resize(1));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[0], false));
+  EXPECT_TRUE(bpm->Resize(1));
+  EXPECT_EQ(1U, bpm->GetNumInstances());
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  check_pages();
+
+  // Scenario: growing again brings the retired instances back instead of piling up new ones, and they neither lose
+  // pages nor hand out ids that are in use. Filling the pool shows which frames it is made of.
+  auto fill_pool = [&] {
+    std::set<Page *> frames;
+    std::vector<page_id_t> filled;
+    for (size_t i = 0; i < 4 * buffer_pool_size; ++i) {
+      Page *page = bpm->NewPage(&page_id_temp);
+      EXPECT_NE(nullptr, page);
+      EXPECT_EQ(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), page_id_temp));
+      EXPECT_EQ(new_page_ids.end(), std::find(new_page_ids.begin(), new_page_ids.end(), page_id_temp));
+      frames.insert(page);
+      filled.push_back(page_id_temp);
+    }
+    for (page_id_t page_id : filled) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      EXPECT_TRUE(bpm->DeletePage(page_id));
+    }
+    return frames;
+  };
+  EXPECT_TRUE(bpm->Resize(4));
+  const std::set<Page *> frames = fill_pool();
+  EXPECT_EQ(4 * buffer_pool_size, frames.size());
+  EXPECT_TRUE(bpm->Resize(1));
+  EXPECT_TRUE(bpm->Resize(4));
+  EXPECT_EQ(frames, fill_pool());
+  check_pages();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_pages = 200;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: readers keep fetching and dirtying pages while the pool is resized underneath them.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([bpm, &done, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      char expected[PAGE_SIZE];
+      while (!done) {
+        page_id_t page_id = page_dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, tid % 2 == 0));
+      }
+    });
+  }
+  for (size_t num_instances : {4, 1, 3, 8, 2}) {
+    while (!bpm->Resize(num_instances)) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(num_instances, bpm->GetNumInstances());
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+  const page_id_t num_pages = buffer_pool_size * num_instances;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+
+  // Twice as many new dirty pages as frames: the second half evicts the first.
+  for (page_id_t i = 0; i < 2 * num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.evictions_);
+  EXPECT_EQ(num_pages, stats.dirty_write_backs_);
+  EXPECT_EQ(0, stats.hits_ + stats.misses_);
+
+  // Resident pages are hits, the others misses that evict the dirty resident ones.
+  for (page_id_t i = num_pages; i < 2 * num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  bpm->FlushAllPages();
+
+  stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.hits_);
+  EXPECT_EQ(num_pages, stats.misses_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(2 * num_pages, stats.evictions_);
+  EXPECT_EQ(2 * num_pages, stats.dirty_write_backs_);
+  EXPECT_EQ(num_pages, stats.flushed_pages_);
+  EXPECT_EQ(0, stats.pin_waits_);
+  EXPECT_EQ(num_pages, stats.pool_size_);
+  EXPECT_EQ(0, stats.free_frames_);
+  EXPECT_EQ(num_pages, stats.evictable_frames_);
+  EXPECT_EQ(num_pages, disk_manager->GetNumReads());
+
+  // The pool stats are the instance stats added up.
+  std::vector<BufferPoolStats> instance_stats = bpm->GetInstanceStats();
+  ASSERT_EQ(num_instances, instance_stats.size());
+  EXPECT_EQ(stats.hits_, instance_stats[0].hits_ + instance_stats[1].hits_);
+  EXPECT_EQ(buffer_pool_size, instance_stats[0].pool_size_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 4;
+  const page_id_t num_pages = buffer_pool_size * num_instances;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 2 * num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Pages of every instance, half of them resident, in an order that mixes the instances.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t i = num_pages / 2 + num_pages - 1; i >= num_pages / 2; --i) {
+    page_ids.push_back(i);
+  }
+  std::vector<Page *> pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < pages.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(num_pages / 2, stats.hits_);
+  EXPECT_EQ(num_pages / 2, stats.misses_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentNewPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 4;
+  const size_t num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Every thread creates pinned pages until the pool is full. Between them they get every frame, once each.
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, &page_ids, tid] {
+      page_id_t page_id;
+      while (bpm->NewPage(&page_id) != nullptr) {
+        page_ids[tid].push_back(page_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<page_id_t> all_page_ids;
+  for (const auto &thread_page_ids : page_ids) {
+    all_page_ids.insert(all_page_ids.end(), thread_page_ids.begin(), thread_page_ids.end());
+  }
+  std::sort(all_page_ids.begin(), all_page_ids.end());
+  EXPECT_EQ(buffer_pool_size * num_instances, all_page_ids.size());
+  EXPECT_EQ(all_page_ids.end(), std::adjacent_find(all_page_ids.begin(), all_page_ids.end()));
+
+  // Once a page is unpinned, the instance it is in has a frame for a new page again.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(all_page_ids[5], true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(all_page_ids.end(), std::find(all_page_ids.begin(), all_page_ids.end(), page_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
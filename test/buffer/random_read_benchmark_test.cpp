@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// random_read_benchmark_test.cpp
+//
+// Identification: test/buffer/random_read_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <future>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+namespace {
+
+const page_id_t benchmark_num_pages = 4096;
+const size_t benchmark_reads = 16384;
+const size_t benchmark_queue_depth = 32;
+
+/** Fill the database file with benchmark_num_pages pages. */
+void CreateBenchmarkFile(DiskManager *disk_manager) {
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < benchmark_num_pages; ++page_id) {
+    data[0] = static_cast<char>(page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+}
+
+/** @return reads per second of benchmark_reads random pages, one ReadPage at a time */
+double RunSyncReads(DiskManager *disk_manager) {
+  std::default_random_engine rng(0);
+  std::uniform_int_distribution<page_id_t> page_dist(0, benchmark_num_pages - 1);
+  char data[PAGE_SIZE];
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < benchmark_reads; ++i) {
+    disk_manager->ReadPage(page_dist(rng), data);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(benchmark_reads) / elapsed.count();
+}
+
+/** @return reads per second of benchmark_reads random pages, benchmark_queue_depth asynchronous reads at a time */
+double RunAsyncReads(DiskManager *disk_manager) {
+  std::default_random_engine rng(0);
+  std::uniform_int_distribution<page_id_t> page_dist(0, benchmark_num_pages - 1);
+  std::vector<char> buffers(benchmark_queue_depth * PAGE_SIZE);
+  std::vector<std::future<bool>> reads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < benchmark_reads; i += benchmark_queue_depth) {
+    for (size_t j = 0; j < benchmark_queue_depth; ++j) {
+      reads.push_back(disk_manager->ReadPageAsync(page_dist(rng), &buffers[j * PAGE_SIZE]));
+    }
+    disk_manager->SubmitAsync();
+    for (auto &read : reads) {
+      EXPECT_TRUE(read.get());
+    }
+    reads.clear();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(benchmark_reads) / elapsed.count();
+}
+
+/** @return fetches per second of random pages through a buffer pool much smaller than the file */
+double RunBufferPoolReads(BufferPoolManager *bpm, size_t num_threads) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid, num_threads] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, benchmark_num_pages - 1);
+      for (size_t i = 0; i < benchmark_reads / num_threads; ++i) {
+        page_id_t page_id = page_dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(static_cast<char>(page_id), page->GetData()[0]);
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(benchmark_reads) / elapsed.count();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(RandomReadBenchmarkTest, DISABLED_DiskManagerIOPS) {
+  const bool saved_enable_io_uring = enable_io_uring;
+  std::string db_file("random_read_benchmark.db");
+  {
+    DiskManager disk_manager(db_file);
+    CreateBenchmarkFile(&disk_manager);
+    disk_manager.ShutDown();
+  }
+
+  // The file is small enough to stay in the page cache, so this compares the per-read overhead of each path rather
+  // than the device.
+  std::cout << std::setw(24) << "backend" << std::setw(16) << "reads/s" << std::endl;
+  {
+    DiskManager disk_manager(db_file);
+    std::cout << std::setw(24) << "pread" << std::setw(16) << std::fixed << std::setprecision(0)
+              << RunSyncReads(&disk_manager) << std::endl;
+    disk_manager.ShutDown();
+  }
+  for (bool use_io_uring : {true, false}) {
+    enable_io_uring = use_io_uring;
+    DiskManager disk_manager(db_file);
+    double throughput = RunAsyncReads(&disk_manager);
+    std::string backend = disk_manager.IsAsyncIoUring() ? "io_uring" : "thread pool";
+    std::cout << std::setw(24) << backend + " QD" + std::to_string(benchmark_queue_depth) << std::setw(16)
+              << std::fixed << std::setprecision(0) << throughput << std::endl;
+    disk_manager.ShutDown();
+  }
+  enable_io_uring = saved_enable_io_uring;
+  remove(db_file.c_str());
+  remove("random_read_benchmark.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RandomReadBenchmarkTest, DISABLED_BufferPoolIOPS) {
+  std::string db_file("random_read_benchmark.db");
+  DiskManager disk_manager(db_file);
+  CreateBenchmarkFile(&disk_manager);
+
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "fetches/s" << std::endl;
+  for (size_t num_threads : {1, 4, 8}) {
+    // 256 frames over 4096 pages: almost every fetch misses and reads from disk.
+    auto bpm = std::make_unique<ParallelBufferPoolManager>(4, 64, &disk_manager);
+    std::cout << std::setw(8) << num_threads << std::setw(16) << std::fixed << std::setprecision(0)
+              << RunBufferPoolReads(bpm.get(), num_threads) << std::endl;
+  }
+
+  disk_manager.ShutDown();
+  remove(db_file.c_str());
+  remove("random_read_benchmark.log");
+}
+
+}  // namespace bustub
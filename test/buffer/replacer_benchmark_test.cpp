@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_benchmark_test.cpp
+//
+// Identification: test/buffer/replacer_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+const size_t benchmark_num_frames = 1024;
+const size_t benchmark_ops_per_thread = 200000;
+
+/**
+ * Drive a replacer the way a buffer pool does: every operation unpins one random frame and pins another, and every
+ * eighth operation also asks for a victim.
+ * @return the number of operations per second over all threads
+ */
+double RunReplacerBenchmark(Replacer *replacer, size_t num_threads) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([replacer, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<frame_id_t> frame_dist(0, benchmark_num_frames - 1);
+      frame_id_t victim;
+      for (size_t i = 0; i < benchmark_ops_per_thread; ++i) {
+        replacer->Unpin(frame_dist(rng));
+        replacer->Pin(frame_dist(rng));
+        if (i % 8 == 0) {
+          replacer->Victim(&victim);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * benchmark_ops_per_thread) / elapsed.count();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ReplacerBenchmarkTest, DISABLED_PinUnpinVictimThroughput) {
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "LRU ops/s" << std::setw(16) << "CLOCK ops/s"
+            << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    auto lru_replacer = std::make_unique<LRUReplacer>(benchmark_num_frames);
+    auto clock_replacer = std::make_unique<ClockReplacer>(benchmark_num_frames);
+    double lru_throughput = RunReplacerBenchmark(lru_replacer.get(), num_threads);
+    double clock_throughput = RunReplacerBenchmark(clock_replacer.get(), num_threads);
+    std::cout << std::setw(8) << num_threads << std::setw(16) << std::fixed << std::setprecision(0) << lru_throughput
+              << std::setw(16) << clock_throughput << std::endl;
+
+    // Both replacers must still be consistent after the concurrent run.
+    EXPECT_LE(lru_replacer->Size(), benchmark_num_frames);
+    EXPECT_LE(clock_replacer->Size(), benchmark_num_frames);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bustub_config_test.cpp
+//
+// Identification: test/common/bustub_config_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "common/bustub_config.h"
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BustubConfigTest, FromEnvironmentTest) {
+  // Scenario: without any variables set, the defaults are the compile-time constants.
+  BustubConfig config = BustubConfig::FromEnvironment();
+  EXPECT_EQ(static_cast<size_t>(BUFFER_POOL_SIZE), config.buffer_pool_size_);
+  EXPECT_EQ(1U, config.num_instances_);
+  EXPECT_EQ(ReplacerType::LRU, config.replacer_type_);
+  EXPECT_EQ(static_cast<size_t>(LOG_BUFFER_SIZE), config.log_buffer_size_);
+
+  // Scenario: every field can be set from the environment.
+  setenv("BUSTUB_BUFFER_POOL_SIZE", "1024", 1);
+  setenv("BUSTUB_BUFFER_POOL_INSTANCES", "4", 1);
+  setenv("BUSTUB_REPLACER", "lru-k", 1);
+  setenv("BUSTUB_LOG_BUFFER_SIZE", "65536", 1);
+  config = BustubConfig::FromEnvironment();
+  EXPECT_EQ(1024U, config.buffer_pool_size_);
+  EXPECT_EQ(4U, config.num_instances_);
+  EXPECT_EQ(ReplacerType::LRU_K, config.replacer_type_);
+  EXPECT_EQ(65536U, config.log_buffer_size_);
+
+  // Scenario: malformed or unusable values are rejected.
+  setenv("BUSTUB_REPLACER", "fifo", 1);
+  EXPECT_THROW(BustubConfig::FromEnvironment(), Exception);
+  setenv("BUSTUB_REPLACER", "clock", 1);
+  setenv("BUSTUB_BUFFER_POOL_SIZE", "10k", 1);
+  EXPECT_THROW(BustubConfig::FromEnvironment(), Exception);
+  setenv("BUSTUB_BUFFER_POOL_SIZE", "0", 1);
+  EXPECT_THROW(BustubConfig::FromEnvironment(), Exception);
+  setenv("BUSTUB_BUFFER_POOL_SIZE", "1024", 1);
+  setenv("BUSTUB_LOG_BUFFER_SIZE", "16", 1);
+  EXPECT_THROW(BustubConfig::FromEnvironment(), Exception);
+
+  unsetenv("BUSTUB_BUFFER_POOL_SIZE");
+  unsetenv("BUSTUB_BUFFER_POOL_INSTANCES");
+  unsetenv("BUSTUB_REPLACER");
+  unsetenv("BUSTUB_LOG_BUFFER_SIZE");
+}
+
+// NOLINTNEXTLINE
+TEST(BustubConfigTest, BustubInstanceTest) {
+  BustubConfig config;
+  config.buffer_pool_size_ = 64;
+  config.num_instances_ = 4;
+  config.replacer_type_ = ReplacerType::CLOCK;
+  config.log_buffer_size_ = 8 * PAGE_SIZE;
+
+  // Scenario: the instance sizes its buffer pool and log buffer from the configuration.
+  auto *bustub_instance = new BustubInstance("test.db", config);
+  EXPECT_EQ(config.buffer_pool_size_ * config.num_instances_, bustub_instance->buffer_pool_manager_->GetPoolSize());
+  EXPECT_EQ(config.log_buffer_size_, bustub_instance->log_manager_->GetLogBufferSize());
+
+  // Scenario: all frames of all instances can be used.
+  page_id_t page_id;
+  for (size_t i = 0; i < config.buffer_pool_size_ * config.num_instances_; ++i) {
+    EXPECT_NE(nullptr, bustub_instance->buffer_pool_manager_->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bustub_instance->buffer_pool_manager_->NewPage(&page_id));
+  delete bustub_instance;
+
+  // Scenario: an unusable configuration is rejected up front.
+  config.num_instances_ = 0;
+  EXPECT_THROW(BustubInstance("test.db", config), Exception);
+
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "common/config.h"
+#include "common/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // Check values from RFC 3720, appendix B.4.
+  const char *check = "123456789";
+  EXPECT_EQ(0xE3069283U, Crc32c::Compute(check, std::strlen(check)));
+  EXPECT_EQ(0xE3069283U, Crc32c::ComputeWithTable(check, std::strlen(check)));
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8A9136AAU, Crc32c::Compute(zeros.data(), zeros.size()));
+  std::vector<char> ones(32, static_cast<char>(0xff));
+  EXPECT_EQ(0x62A8AB43U, Crc32c::Compute(ones.data(), ones.size()));
+  EXPECT_EQ(0U, Crc32c::Compute(nullptr, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, HardwareMatchesTableTest) {
+  std::cout << "CRC32C: " << (Crc32c::IsHardware() ? "hardware" : "table") << std::endl;
+  std::mt19937 rng(42);
+  std::vector<char> data(3 * PAGE_SIZE);
+  for (auto &c : data) {
+    c = static_cast<char>(rng());
+  }
+  // Every size around the stream boundaries and a few past them, from unaligned starts, in one piece and in two.
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t size = 0; size <= 2 * PAGE_SIZE; size += (size < 64 || size > 4000 ? 1 : 61)) {
+      const char *start = data.data() + offset;
+      const uint32_t expected = Crc32c::ComputeWithTable(start, size);
+      ASSERT_EQ(expected, Crc32c::Compute(start, size)) << "offset " << offset << " size " << size;
+      const size_t half = size / 2;
+      ASSERT_EQ(expected, Crc32c::Compute(start + half, size - half, Crc32c::Compute(start, half)));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, PageThroughputTest) {
+  const int num_pages = 100000;
+  std::vector<char> page(PAGE_SIZE, 7);
+  uint32_t crc = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; i++) {
+    page[0] = static_cast<char>(crc);
+    crc = Crc32c::Compute(page.data(), page.size());
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "CRC32C of a page: " << elapsed / num_pages << " ns" << std::endl;
+  EXPECT_EQ(crc, Crc32c::ComputeWithTable(page.data(), page.size()));
+}
+
+}  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rwlatch_benchmark_test.cpp
+//
+// Identification: test/common/rwlatch_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <shared_mutex>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+const size_t benchmark_ops_per_thread = 500000;
+/** Every this many operations, thread 0 takes the write latch instead of the read latch. */
+const size_t benchmark_write_interval = 10000;
+
+/** std::shared_mutex behind the latch interface, for reference. */
+class SharedMutexLatch {
+ public:
+  void WLock() { mutex_.lock(); }
+  void WUnlock() { mutex_.unlock(); }
+  void RLock() { mutex_.lock_shared(); }
+  void RUnlock() { mutex_.unlock_shared(); }
+
+ private:
+  std::shared_mutex mutex_;
+};
+
+/**
+ * Hammer a read-mostly latch: every operation read latches it and reads a counter, and thread 0 now and then write
+ * latches it and bumps the counter.
+ * @return the number of read latches per second over all threads
+ */
+template <class Latch>
+double RunRWLatchBenchmark(size_t num_threads, size_t *counter) {
+  Latch latch;
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&latch, counter, tid] {
+      size_t sum = 0;
+      for (size_t i = 1; i <= benchmark_ops_per_thread; ++i) {
+        if (tid == 0 && i % benchmark_write_interval == 0) {
+          latch.WLock();
+          ++*counter;
+          latch.WUnlock();
+          continue;
+        }
+        latch.RLock();
+        sum += *counter;
+        latch.RUnlock();
+      }
+      // Every read saw at most every write.
+      EXPECT_LE(sum, benchmark_ops_per_thread * (benchmark_ops_per_thread / benchmark_write_interval));
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * benchmark_ops_per_thread) / elapsed.count();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(RWLatchBenchmarkTest, DISABLED_ReaderThroughput) {
+  std::cout << std::setw(8) << "threads" << std::setw(20) << "ReaderWriter ops/s" << std::setw(20) << "PerCore ops/s"
+            << std::setw(20) << "shared_mutex ops/s" << std::endl;
+  const size_t writes = benchmark_ops_per_thread / benchmark_write_interval;
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    size_t rw_counter = 0;
+    size_t per_core_counter = 0;
+    size_t shared_mutex_counter = 0;
+    double rw_throughput = RunRWLatchBenchmark<ReaderWriterLatch>(num_threads, &rw_counter);
+    double per_core_throughput = RunRWLatchBenchmark<PerCoreReaderWriterLatch>(num_threads, &per_core_counter);
+    double shared_mutex_throughput = RunRWLatchBenchmark<SharedMutexLatch>(num_threads, &shared_mutex_counter);
+    std::cout << std::setw(8) << num_threads << std::setw(20) << std::fixed << std::setprecision(0) << rw_throughput
+              << std::setw(20) << per_core_throughput << std::setw(20) << shared_mutex_throughput << std::endl;
+
+    // No write may have been lost to a reader or another writer.
+    EXPECT_EQ(rw_counter, writes);
+    EXPECT_EQ(per_core_counter, writes);
+    EXPECT_EQ(shared_mutex_counter, writes);
+  }
+}
+
+}  // namespace bustub
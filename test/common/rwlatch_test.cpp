@@ -18,6 +18,7 @@
 
 namespace bustub {
 
+template <class Latch>
 class Counter {
  public:
   Counter() = default;
@@ -36,13 +37,13 @@ class Counter {
 
  private:
   int count_{0};
-  ReaderWriterLatch mutex_{};
+  Latch mutex_{};
 };
 
-// NOLINTNEXTLINE
-TEST(RWLatchTest, BasicTest) {
+template <class Latch>
+void RunCounterTest() {
   int num_threads = 100;
-  Counter counter{};
+  Counter<Latch> counter{};
   counter.Add(5);
   std::vector<std::thread> threads;
   for (int tid = 0; tid < num_threads; tid++) {
@@ -57,4 +58,10 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, BasicTest) { RunCounterTest<ReaderWriterLatch>(); }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, PerCoreTest) { RunCounterTest<PerCoreReaderWriterLatch>(); }
 }  // namespace bustub
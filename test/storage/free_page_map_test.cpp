@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map_test.cpp
+//
+// Identification: test/storage/free_page_map_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/free_page_map.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreePageMapTest, ReuseTest) {
+  const std::string file_name = "test.fsm";
+  remove(file_name.c_str());
+  auto map = std::make_unique<FreePageMap>(file_name);
+  auto any = [](page_id_t /*id*/) { return true; };
+  page_id_t page_id;
+
+  EXPECT_EQ(0, map->GetNextPageId());
+  EXPECT_FALSE(map->Reuse(&page_id, any));
+  map->Reserve(0);
+  EXPECT_EQ(PAGE_ID_RESERVATION, map->GetNextPageId());
+  map->Reserve(PAGE_ID_RESERVATION - 1);
+  EXPECT_EQ(PAGE_ID_RESERVATION, map->GetNextPageId());
+
+  // Free ids are reused lowest first, each of them once, including ids past the first bitmap block.
+  const page_id_t far_page_id = PAGE_SIZE * 8 + 6;
+  map->Free(far_page_id);
+  map->Free(7);
+  map->Free(3);
+  map->Free(3);
+  EXPECT_EQ(3, map->GetNumFree());
+  ASSERT_TRUE(map->Reuse(&page_id, any));
+  EXPECT_EQ(3, page_id);
+  ASSERT_TRUE(map->Reuse(&page_id, [](page_id_t id) { return id % 2 == 0; }));
+  EXPECT_EQ(far_page_id, page_id);
+  EXPECT_FALSE(map->Reuse(&page_id, [](page_id_t id) { return id % 2 == 0; }));
+  EXPECT_EQ(1, map->GetNumFree());
+
+  // The free ids and the next page id survive reopening.
+  map->Free(11);
+  map.reset();
+  map = std::make_unique<FreePageMap>(file_name);
+  EXPECT_EQ(PAGE_ID_RESERVATION, map->GetNextPageId());
+  EXPECT_EQ(2, map->GetNumFree());
+  ASSERT_TRUE(map->Reuse(&page_id, any));
+  EXPECT_EQ(7, page_id);
+  ASSERT_TRUE(map->Reuse(&page_id, any));
+  EXPECT_EQ(11, page_id);
+  EXPECT_FALSE(map->Reuse(&page_id, any));
+
+  map.reset();
+  remove(file_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(FreePageMapTest, NewDatabaseTest) {
+  const std::string db_name = "test.db";
+  remove(db_name.c_str());
+  char data[PAGE_SIZE] = {0};
+  page_id_t page_id;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto map = disk_manager->OpenFreePageMap(0);
+  map->Reserve(0);
+  map->Free(0);
+  map.reset();
+  disk_manager->WritePage(0, data);
+  delete disk_manager;
+
+  // The map of an existing database is kept...
+  disk_manager = new DiskManager(db_name);
+  map = disk_manager->OpenFreePageMap(0);
+  EXPECT_EQ(1, map->GetNumFree());
+  map.reset();
+  delete disk_manager;
+
+  // ...and the one left behind by a database that was removed is not.
+  remove(db_name.c_str());
+  disk_manager = new DiskManager(db_name);
+  map = disk_manager->OpenFreePageMap(0);
+  EXPECT_EQ(0, map->GetNextPageId());
+  EXPECT_FALSE(map->Reuse(&page_id, [](page_id_t /*id*/) { return true; }));
+  map.reset();
+  delete disk_manager;
+
+  remove(db_name.c_str());
+  remove("test.log");
+  remove((db_name + ".fsm.0").c_str());
+}
+
+}  // namespace bustub
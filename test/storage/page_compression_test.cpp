@@ -0,0 +1,222 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compression_test.cpp
+//
+// Identification: test/storage/page_compression_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/lz4_codec.h"
+#include "storage/disk/page_mapping_table.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fill a page like a table page of small integer tuples. */
+void FillIntegerPage(char *data, int seed) {
+  std::vector<int32_t> values(PAGE_SIZE / sizeof(int32_t));
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i % 4 == 0 ? seed : static_cast<int32_t>(i % 97);
+  }
+  memcpy(data, values.data(), PAGE_SIZE);
+}
+
+void FillRandomPage(char *data, int seed) {
+  std::mt19937 rng(seed);
+  for (int i = 0; i < PAGE_SIZE; ++i) {
+    data[i] = static_cast<char>(rng());
+  }
+}
+
+int64_t FileSize(const std::string &file_name) {
+  struct stat stat_buf;
+  return stat(file_name.c_str(), &stat_buf) == 0 ? stat_buf.st_size : -1;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(PageCompressionTest, CodecTest) {
+  char page[PAGE_SIZE];
+  char compressed[2 * PAGE_SIZE];
+  char decompressed[PAGE_SIZE];
+  auto round_trip = [&](size_t size) {
+    const size_t compressed_size = Lz4Codec::Compress(page, size, compressed, sizeof(compressed));
+    EXPECT_NE(0, compressed_size);
+    EXPECT_TRUE(Lz4Codec::Decompress(compressed, compressed_size, decompressed, size));
+    EXPECT_EQ(0, memcmp(page, decompressed, size));
+    return compressed_size;
+  };
+
+  memset(page, 0, PAGE_SIZE);
+  EXPECT_LT(round_trip(PAGE_SIZE), 64);
+  FillIntegerPage(page, 42);
+  EXPECT_LT(round_trip(PAGE_SIZE), PAGE_SIZE / 3);
+  FillRandomPage(page, 42);
+  EXPECT_GT(round_trip(PAGE_SIZE), PAGE_SIZE);
+  round_trip(0);
+  round_trip(13);
+
+  // Incompressible data does not fit into a buffer smaller than itself.
+  EXPECT_EQ(0, Lz4Codec::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE));
+
+  // Truncated or mangled input is rejected rather than overrunning the output.
+  FillIntegerPage(page, 7);
+  const size_t compressed_size = Lz4Codec::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+  EXPECT_FALSE(Lz4Codec::Decompress(compressed, compressed_size - 1, decompressed, PAGE_SIZE));
+  EXPECT_FALSE(Lz4Codec::Decompress(compressed, compressed_size, decompressed, PAGE_SIZE - 1));
+  std::mt19937 rng(7);
+  for (int i = 0; i < 100; ++i) {
+    std::vector<char> mangled(compressed, compressed + compressed_size);
+    mangled[rng() % compressed_size] ^= static_cast<char>(1 + rng() % 255);
+    Lz4Codec::Decompress(mangled.data(), mangled.size(), decompressed, PAGE_SIZE);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageCompressionTest, DiskManagerTest) {
+  const std::string db_name = "test_compression.db";
+  remove(db_name.c_str());
+  enable_page_compression = true;
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  enable_page_compression = false;
+  ASSERT_TRUE(disk_manager->IsPageCompression());
+
+  const int num_pages = 100;
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  for (int i = 0; i < num_pages; ++i) {
+    FillIntegerPage(data, i);
+    disk_manager->WritePage(i, data);
+  }
+  // An incompressible page is stored as it is.
+  FillRandomPage(data, 0);
+  disk_manager->WritePage(num_pages, data);
+  disk_manager->ReadPage(num_pages, buffer);
+  EXPECT_EQ(0, memcmp(data, buffer, PAGE_SIZE));
+  // The pages are packed, into far less than a page each.
+  EXPECT_LT(FileSize(db_name), num_pages * PAGE_SIZE / 3 + PAGE_SIZE);
+
+  // Pages that grow or shrink move to other extents, which are reused rather than appended.
+  FillRandomPage(data, 1);
+  disk_manager->WritePage(3, data);
+  FillIntegerPage(data, 1000);
+  disk_manager->WritePage(num_pages, data);
+  std::future<bool> write = disk_manager->WritePageAsync(5, data);
+  disk_manager->SubmitAsync();
+  EXPECT_TRUE(write.get());
+  const int64_t file_size = FileSize(db_name);
+  FillIntegerPage(data, 3);
+  disk_manager->WritePage(3, data);
+  EXPECT_EQ(file_size, FileSize(db_name));
+
+  // A page that was never written reads as zeros.
+  disk_manager->ReadPage(num_pages + 1, buffer);
+  for (char byte : buffer) {
+    ASSERT_EQ(0, byte);
+  }
+
+  // Reopened, the file is still compressed even though the flag is not set, and every page reads back.
+  disk_manager->ShutDown();
+  disk_manager = std::make_unique<DiskManager>(db_name);
+  ASSERT_TRUE(disk_manager->IsPageCompression());
+  for (int i = 0; i <= num_pages; ++i) {
+    FillIntegerPage(data, i == 5 || i == num_pages ? 1000 : i);
+    std::future<bool> read = disk_manager->ReadPageAsync(i, buffer);
+    disk_manager->SubmitAsync();
+    EXPECT_TRUE(read.get());
+    EXPECT_EQ(0, memcmp(data, buffer, PAGE_SIZE)) << "page " << i;
+  }
+
+  disk_manager->ShutDown();
+  disk_manager.reset();
+  remove(db_name.c_str());
+  remove((db_name + ".map").c_str());
+  remove("test_compression.log");
+}
+
+// NOLINTNEXTLINE
+TEST(PageCompressionTest, PageMappingTableTest) {
+  const std::string map_name = "test_compression.map";
+  remove(map_name.c_str());
+  auto table = std::make_unique<PageMappingTable>(map_name, true);
+
+  const PageMappingTable::Entry first = table->Place(0, PAGE_SIZE, false);
+  ASSERT_TRUE(table->Persist(0));
+  const PageMappingTable::Entry moved = table->Place(0, 100, true);
+  EXPECT_NE(first.offset_, moved.offset_);
+
+  // Until the new entry of page 0 is persisted, the file still points at its old extent, which must not be reused.
+  EXPECT_NE(first.offset_, table->Place(1, PAGE_SIZE, false).offset_);
+  ASSERT_TRUE(table->Persist(1));
+  ASSERT_TRUE(table->Persist(0));
+  EXPECT_EQ(first.offset_, table->Place(2, PAGE_SIZE, false).offset_);
+  ASSERT_TRUE(table->Persist(2));
+
+  // Reopened, every entry is where it was persisted.
+  table = std::make_unique<PageMappingTable>(map_name, false);
+  PageMappingTable::Entry entry;
+  ASSERT_TRUE(table->Find(0, &entry));
+  EXPECT_EQ(moved.offset_, entry.offset_);
+  EXPECT_EQ(100, entry.size_);
+  ASSERT_TRUE(table->Find(2, &entry));
+  EXPECT_EQ(first.offset_, entry.offset_);
+
+  table.reset();
+  remove(map_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(PageCompressionTest, BufferPoolTest) {
+  const std::string db_name = "test_compression.db";
+  const size_t buffer_pool_size = 10;
+  remove(db_name.c_str());
+  enable_page_compression = true;
+  auto *disk_manager = new DiskManager(db_name);
+  enable_page_compression = false;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Pages go through compression when they are evicted, and through decompression when they are fetched again.
+  page_id_t page_id;
+  for (int i = 0; i < 5 * static_cast<int>(buffer_pool_size); ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    FillIntegerPage(page->GetData(), page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  char data[PAGE_SIZE];
+  for (page_id_t i = 0; i < 5 * static_cast<page_id_t>(buffer_pool_size); ++i) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    FillIntegerPage(data, i);
+    EXPECT_EQ(0, memcmp(data, page->GetData(), PAGE_SIZE)) << "page " << i;
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove((db_name + ".map").c_str());
+  remove((db_name + ".fsm.0").c_str());
+  remove("test_compression.log");
+}
+
+}  // namespace bustub
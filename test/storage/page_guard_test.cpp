@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, PinAndDirtyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  remove(db_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  Page *page;
+  {
+    BasicPageGuard guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard);
+    page = guard.GetPage();
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(1, page->GetPinCount());
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+  }
+  // The guard unpinned the page and marked it dirty.
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+  bpm->FlushPage(page_id);
+  EXPECT_FALSE(page->IsDirty());
+
+  {
+    // Reading does not dirty the page, and a moved-from guard holds nothing.
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+    ReadPageGuard other = std::move(guard);
+    EXPECT_FALSE(guard);  // NOLINT
+    EXPECT_EQ(1, page->GetPinCount());
+    // A second reader can share the latch.
+    ReadPageGuard second = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_FALSE(page->IsDirty());
+
+  {
+    // Assigning to a guard releases what it held first.
+    WritePageGuard guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+    page_id_t other_page_id;
+    guard = bpm->NewPageGuarded(&other_page_id).UpgradeWrite();
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_FALSE(page->IsDirty());
+    EXPECT_EQ(other_page_id, guard.PageId());
+  }
+
+  {
+    // A page kept pinned between latches, as a loop would carry it.
+    BasicPageGuard pinned = bpm->FetchPageBasic(page_id);
+    for (int i = 0; i < 3; ++i) {
+      WritePageGuard guard = pinned.UpgradeWrite();
+      guard.GetDataMut()[0] = static_cast<char>('a' + i);
+      pinned = guard.Unlatch();
+      EXPECT_EQ(1, page->GetPinCount());
+    }
+    EXPECT_EQ('c', pinned.GetData()[0]);
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+
+  // A page that cannot be fetched gives an empty guard.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    guards.push_back(bpm->NewPageGuarded(&page_id));
+  }
+  EXPECT_FALSE(bpm->FetchPageRead(page_id + 1));
+  EXPECT_FALSE(bpm->NewPageGuarded(&page_id));
+
+  guards.clear();
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticReadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  remove(db_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  {
+    WritePageGuard guard = bpm->NewPageGuarded(&page_id).UpgradeWrite();
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+  }
+
+  // An optimistic read of an unchanged page validates, one across a write does not.
+  OptimisticPageGuard guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(guard);
+  EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  EXPECT_TRUE(guard.Validate());
+  {
+    WritePageGuard write_guard = bpm->FetchPageWrite(page_id);
+    // Not while the page is being written.
+    EXPECT_FALSE(bpm->FetchPageOptimistic(page_id));
+  }
+  EXPECT_FALSE(guard.Validate());
+
+  // Nor across the page leaving its frame.
+  guard = bpm->FetchPageOptimistic(page_id);
+  ASSERT_TRUE(guard.Validate());
+  page_id_t other_page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_TRUE(bpm->NewPageGuarded(&other_page_id));
+  }
+  EXPECT_FALSE(guard.Validate());
+  EXPECT_FALSE(bpm->FetchPageOptimistic(page_id));
+
+  // Readers racing a writer only ever validate consistent contents. Both sides use atomic accesses to the page
+  // contents, so that the race is well-defined.
+  {
+    WritePageGuard write_guard = bpm->FetchPageWrite(page_id);
+    ASSERT_TRUE(write_guard);
+    memset(write_guard.GetDataMut(), 0, 2 * sizeof(int));
+  }
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int i = 1; i <= 2000; ++i) {
+      WritePageGuard write_guard = bpm->FetchPageWrite(page_id);
+      auto *values = reinterpret_cast<int *>(write_guard.GetDataMut());
+      __atomic_store_n(&values[0], i, __ATOMIC_RELAXED);
+      __atomic_store_n(&values[1], i, __ATOMIC_RELAXED);
+    }
+    done = true;
+  });
+  size_t validated = 0;
+  while (!done) {
+    OptimisticPageGuard read_guard = bpm->FetchPageOptimistic(page_id);
+    if (!read_guard) {
+      continue;
+    }
+    const auto *values = read_guard.As<int>();
+    const int first = __atomic_load_n(&values[0], __ATOMIC_RELAXED);
+    const int second = __atomic_load_n(&values[1], __ATOMIC_RELAXED);
+    if (read_guard.Validate()) {
+      EXPECT_EQ(first, second);
+      validated++;
+    }
+  }
+  writer.join();
+  EXPECT_GT(validated, 0);
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+}  // namespace bustub
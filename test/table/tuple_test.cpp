@@ -21,6 +21,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +72,49 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapScanTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 40};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // The table takes up several times the buffer pool.
+  const int num_tuples = 10000;
+  for (int i = 0; i < num_tuples; ++i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue("tuple " + std::to_string(i))};
+    Tuple tuple(values, &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+
+  // A scan through the scan ring with read-ahead returns every tuple in insertion order, twice in a row.
+  for (int round = 0; round < 2; ++round) {
+    int count = 0;
+    for (auto itr = table->Begin(transaction, AccessType::Scan); itr != table->End(); ++itr) {
+      EXPECT_EQ(count, itr->GetValue(&schema, 0).GetAs<int32_t>());
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub